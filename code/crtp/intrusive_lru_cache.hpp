@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "linked_list.hpp"
+
+namespace cpp_idioms {
+
+// The base of the entries of an IntrusiveLruCache<Key, T>, which is a
+// LinkNode<T> for the recency list and holds the key and the size of the
+// entry.
+template <typename Key, typename T>
+class LruCacheEntry : public LinkNode<T> {
+ public:
+  explicit LruCacheEntry(Key key, std::size_t bytes = 0)
+      : key_(std::move(key)), bytes_(bytes) {}
+
+  const Key& CacheKey() const { return key_; }
+
+  // What the entry counts against the byte bound of the cache
+  std::size_t CacheBytes() const { return bytes_; }
+
+ private:
+  const Key key_;
+  const std::size_t bytes_;
+};
+
+// A least recently used cache of entries that extend LruCacheEntry<Key, T>.
+//
+//   class Page : public LruCacheEntry<std::string, Page> { ... };
+//
+//   IntrusiveLruCache<std::string, Page> cache(1024, 64 << 20);
+//   if (Page* page = cache.Find(url)) return page;
+//   LinkedList<Page> evicted;
+//   cache.Insert(new Page(url, ...), &evicted);
+//   while (!evicted.Empty()) {
+//     LinkNode<Page>* node = evicted.Head();
+//     node->RemoveFromList();
+//     delete node->Value();
+//   }
+//
+// The recency list is a LinkedList through the entries themselves, so a hit
+// moves its entry to the front with RemoveFromList() and InsertBefore(),
+// without allocating. The index is an open-addressing hash table of entry
+// pointers with linear probing, which doubles when it gets half full, so a
+// cache bounded by bytes alone can pass the maximum for max_entries. Insert()
+// evicts from the back of the list while the cache holds more than
+// max_entries entries or max_bytes bytes.
+//
+// The cache does not own its entries: Insert() hands evicted and replaced
+// entries back in a LinkedList, and Clear() all of them. Entries must stay
+// alive while they are in the cache.
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class IntrusiveLruCache {
+ public:
+  explicit IntrusiveLruCache(
+      std::size_t max_entries,
+      std::size_t max_bytes = std::numeric_limits<std::size_t>::max())
+      : max_entries_(max_entries),
+        max_bytes_(max_bytes),
+        size_(0),
+        bytes_(0),
+        slots_(kMinSlots),
+        mask_(kMinSlots - 1) {}
+
+  IntrusiveLruCache(const IntrusiveLruCache&) = delete;
+  IntrusiveLruCache& operator=(const IntrusiveLruCache&) = delete;
+
+  // The entry with key, which becomes the most recently used, or nullptr.
+  T* Find(const Key& key) {
+    T* entry = slots_[FindSlot(key, hash_(key))].entry;
+    if (entry) Touch(entry);
+    return entry;
+  }
+
+  // Like Find(), but leaves the recency order alone.
+  T* Peek(const Key& key) const {
+    return slots_[FindSlot(key, hash_(key))].entry;
+  }
+
+  // Insert entry as the most recently used entry. An entry with the same
+  // key, and the entries evicted to stay within the bounds, are appended to
+  // evicted, least recently used first. An entry larger than max_bytes, or
+  // any entry if max_entries is 0, is appended to evicted alone and leaves
+  // the cache as it is. Inserting an entry that is in the cache touches it.
+  void Insert(T* entry, LinkedList<T>* evicted) {
+    if (entry->CacheBytes() > max_bytes_ || max_entries_ == 0) {
+      evicted->Append(entry);
+      return;
+    }
+    // at most half full, with room for the entry added before evicting
+    if (2 * (size_ + 1) > slots_.size()) Grow();
+    const std::size_t hash = hash_(entry->CacheKey());
+    const std::size_t slot = FindSlot(entry->CacheKey(), hash);
+    if (T* old = slots_[slot].entry) {
+      if (old == entry) {
+        Touch(entry);
+        return;
+      }
+      old->RemoveFromList();
+      bytes_ -= old->CacheBytes();
+      --size_;
+      evicted->Append(old);
+    }
+    slots_[slot] = {entry, hash};
+    entry->InsertBefore(list_.Head());
+    bytes_ += entry->CacheBytes();
+    ++size_;
+    while (size_ > max_entries_ || bytes_ > max_bytes_) {
+      evicted->Append(Remove(list_.Tail()->Value()));
+    }
+  }
+
+  // Remove the entry with key and return it, or nullptr.
+  T* Erase(const Key& key) {
+    T* entry = Peek(key);
+    return entry ? Remove(entry) : nullptr;
+  }
+
+  // Remove all entries and append them to evicted, least recently used
+  // first.
+  void Clear(LinkedList<T>* evicted) {
+    while (!list_.Empty()) evicted->Append(Remove(list_.Tail()->Value()));
+  }
+
+  // The entries, most recently used first.
+  const LinkedList<T>& Entries() const { return list_; }
+
+  std::size_t Size() const { return size_; }
+  std::size_t Bytes() const { return bytes_; }
+  bool Empty() const { return size_ == 0; }
+  std::size_t MaxEntries() const { return max_entries_; }
+  std::size_t MaxBytes() const { return max_bytes_; }
+
+ private:
+  static constexpr std::size_t kMinSlots = 16;
+
+  struct Slot {
+    T* entry = nullptr;
+    // of the key of entry, which saves comparing keys and rehashing them
+    std::size_t hash = 0;
+  };
+
+  void Touch(T* entry) {
+    entry->RemoveFromList();
+    entry->InsertBefore(list_.Head());
+  }
+
+  // The slot of key, or the empty slot where it would go.
+  std::size_t FindSlot(const Key& key, std::size_t hash) const {
+    std::size_t i = hash & mask_;
+    while (slots_[i].entry && !(slots_[i].hash == hash &&
+                                key_equal_(slots_[i].entry->CacheKey(), key))) {
+      i = (i + 1) & mask_;
+    }
+    return i;
+  }
+
+  // Double the index and put the entries back, by the hashes it keeps.
+  void Grow() {
+    std::vector<Slot> slots(2 * slots_.size());
+    const std::size_t mask = slots.size() - 1;
+    for (const Slot& slot : slots_) {
+      if (!slot.entry) continue;
+      std::size_t i = slot.hash & mask;
+      while (slots[i].entry) i = (i + 1) & mask;
+      slots[i] = slot;
+    }
+    slots_.swap(slots);
+    mask_ = mask;
+  }
+
+  T* Remove(T* entry) {
+    EraseSlot(FindSlot(entry->CacheKey(), hash_(entry->CacheKey())));
+    entry->RemoveFromList();
+    bytes_ -= entry->CacheBytes();
+    --size_;
+    return entry;
+  }
+
+  // Empty slot i and shift back the entries after it that probed past it,
+  // so that lookups need no tombstones.
+  void EraseSlot(std::size_t i) {
+    for (std::size_t j = (i + 1) & mask_; slots_[j].entry;
+         j = (j + 1) & mask_) {
+      // distances from the home slot of the entry at j
+      const std::size_t home = slots_[j].hash & mask_;
+      if (((j - home) & mask_) >= ((j - i) & mask_)) {
+        slots_[i] = slots_[j];
+        i = j;
+      }
+    }
+    slots_[i] = Slot();
+  }
+
+  const std::size_t max_entries_;
+  const std::size_t max_bytes_;
+  std::size_t size_;
+  std::size_t bytes_;
+  // most recently used first
+  LinkedList<T> list_;
+  std::vector<Slot> slots_;
+  std::size_t mask_;
+  Hash hash_;
+  KeyEqual key_equal_;
+};
+
+}  // namespace cpp_idioms
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "intrusive_lru_cache.hpp"
+
+namespace {
+
+using cpp_idioms::IntrusiveLruCache;
+using cpp_idioms::LinkedList;
+using cpp_idioms::LinkNode;
+using cpp_idioms::LruCacheEntry;
+
+constexpr int kEntries = 1 << 16;
+
+class Page : public LruCacheEntry<std::uint64_t, Page> {
+ public:
+  explicit Page(std::uint64_t key) : LruCacheEntry(key), value(key * 3) {}
+
+  std::uint64_t value;
+};
+
+// The cache IntrusiveLruCache replaces: a std::list for the recency order
+// and a std::unordered_map into it, which allocate a node each per insert.
+class StdLruCache {
+ public:
+  explicit StdLruCache(std::size_t max_entries) : max_entries_(max_entries) {
+    index_.reserve(max_entries + 1);
+  }
+
+  const std::uint64_t* Find(std::uint64_t key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    order_.splice(order_.begin(), order_, it->second);
+    return &it->second->second;
+  }
+
+  void Insert(std::uint64_t key, std::uint64_t value) {
+    order_.emplace_front(key, value);
+    index_.emplace(key, order_.begin());
+    if (order_.size() > max_entries_) {
+      index_.erase(order_.back().first);
+      order_.pop_back();
+    }
+  }
+
+ private:
+  using List = std::list<std::pair<std::uint64_t, std::uint64_t>>;
+
+  std::size_t max_entries_;
+  List order_;
+  std::unordered_map<std::uint64_t, List::iterator> index_;
+};
+
+// Keys uniform over state.range(0) percent of kEntries, so that the hit
+// ratio is about 100 / state.range(0) percent once the cache is full.
+std::vector<std::uint64_t> Keys(const benchmark::State& state) {
+  std::mt19937_64 random(42);
+  std::uniform_int_distribution<std::uint64_t> key(
+      0, kEntries * state.range(0) / 100 - 1);
+  std::vector<std::uint64_t> keys(1 << 20);
+  for (std::uint64_t& k : keys) k = key(random);
+  return keys;
+}
+
+void BM_StdLruCache(benchmark::State& state) {
+  const std::vector<std::uint64_t> keys = Keys(state);
+  StdLruCache cache(kEntries);
+  std::size_t i = 0;
+  std::uint64_t sum = 0;
+  for (auto _ : state) {
+    const std::uint64_t key = keys[i++ & (keys.size() - 1)];
+    if (const std::uint64_t* value = cache.Find(key)) {
+      sum += *value;
+    } else {
+      cache.Insert(key, key * 3);
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_StdLruCache)->Arg(100)->Arg(200)->Arg(1000);
+
+void BM_IntrusiveLruCache(benchmark::State& state) {
+  const std::vector<std::uint64_t> keys = Keys(state);
+  IntrusiveLruCache<std::uint64_t, Page> cache(kEntries);
+  // every page the cache ever holds, and the ones it does not hold now
+  std::deque<Page> pages;
+  LinkedList<Page> free;
+  for (int i = 0; i <= kEntries; ++i) {
+    pages.emplace_back(0);
+    free.Append(&pages.back());
+  }
+  std::size_t i = 0;
+  std::uint64_t sum = 0;
+  for (auto _ : state) {
+    const std::uint64_t key = keys[i++ & (keys.size() - 1)];
+    if (const Page* page = cache.Find(key)) {
+      sum += page->value;
+    } else {
+      LinkNode<Page>* node = free.Head();
+      node->RemoveFromList();
+      node->Value()->~Page();
+      cache.Insert(new (node->Value()) Page(key), &free);
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  cache.Clear(&free);
+}
+BENCHMARK(BM_IntrusiveLruCache)->Arg(100)->Arg(200)->Arg(1000);
+
+}  // namespace
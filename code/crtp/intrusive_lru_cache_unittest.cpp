@@ -0,0 +1,169 @@
+#include "intrusive_lru_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+class Page : public LruCacheEntry<int, Page> {
+ public:
+  explicit Page(int key, std::size_t bytes = 0) : LruCacheEntry(key, bytes) {}
+};
+
+// Takes the keys out of list, first to last.
+std::vector<int> Drain(LinkedList<Page>* list) {
+  std::vector<int> keys;
+  while (!list->Empty()) {
+    LinkNode<Page>* node = list->Head();
+    node->RemoveFromList();
+    keys.push_back(node->Value()->CacheKey());
+  }
+  return keys;
+}
+
+std::vector<int> Keys(const LinkedList<Page>& list) {
+  std::vector<int> keys;
+  for (const LinkNode<Page>* node = list.Head(); node != list.End();
+       node = node->Next()) {
+    keys.push_back(node->Value()->CacheKey());
+  }
+  return keys;
+}
+
+TEST(IntrusiveLruCache, EvictsTheLeastRecentlyUsed) {
+  IntrusiveLruCache<int, Page> cache(3);
+  std::deque<Page> pages;
+  for (int key = 0; key < 5; ++key) pages.emplace_back(key);
+  LinkedList<Page> evicted;
+
+  for (int key = 0; key < 3; ++key) cache.Insert(&pages[key], &evicted);
+  EXPECT_TRUE(evicted.Empty());
+  EXPECT_EQ(3u, cache.Size());
+  EXPECT_EQ((std::vector<int>{2, 1, 0}), Keys(cache.Entries()));
+
+  // a hit moves the entry to the front, a peek does not
+  EXPECT_EQ(&pages[0], cache.Find(0));
+  EXPECT_EQ(&pages[1], cache.Peek(1));
+  EXPECT_EQ(nullptr, cache.Find(7));
+  EXPECT_EQ((std::vector<int>{0, 2, 1}), Keys(cache.Entries()));
+
+  cache.Insert(&pages[3], &evicted);
+  cache.Insert(&pages[4], &evicted);
+  EXPECT_EQ((std::vector<int>{1, 2}), Drain(&evicted));
+  EXPECT_EQ((std::vector<int>{4, 3, 0}), Keys(cache.Entries()));
+  EXPECT_EQ(nullptr, cache.Find(1));
+
+  EXPECT_EQ(&pages[3], cache.Erase(3));
+  EXPECT_EQ(nullptr, cache.Erase(3));
+  EXPECT_EQ(2u, cache.Size());
+
+  cache.Clear(&evicted);
+  EXPECT_EQ((std::vector<int>{0, 4}), Drain(&evicted));
+  EXPECT_TRUE(cache.Empty());
+}
+
+TEST(IntrusiveLruCache, BoundsBytes) {
+  IntrusiveLruCache<int, Page> cache(10, 100);
+  Page a(1, 40), b(2, 40), c(3, 30), huge(4, 101);
+  LinkedList<Page> evicted;
+  cache.Insert(&a, &evicted);
+  cache.Insert(&b, &evicted);
+  cache.Insert(&c, &evicted);
+  EXPECT_EQ((std::vector<int>{1}), Drain(&evicted));
+  EXPECT_EQ(70u, cache.Bytes());
+
+  // an entry larger than the bound comes straight back, even in place of
+  // one with its key, and does not flush the others
+  Page huge2(2, 101);
+  cache.Insert(&huge, &evicted);
+  EXPECT_EQ((std::vector<int>{4}), Drain(&evicted));
+  cache.Insert(&huge2, &evicted);
+  EXPECT_EQ((std::vector<int>{2}), Drain(&evicted));
+  EXPECT_EQ(&b, cache.Peek(2));
+  EXPECT_EQ((std::vector<int>{3, 2}), Keys(cache.Entries()));
+  EXPECT_EQ(70u, cache.Bytes());
+
+  // replacing an entry hands back the old one
+  Page b2(2, 10);
+  cache.Insert(&b2, &evicted);
+  EXPECT_EQ((std::vector<int>{2}), Drain(&evicted));
+  EXPECT_EQ(&b2, cache.Find(2));
+  EXPECT_EQ(40u, cache.Bytes());
+  cache.Clear(&evicted);
+  Drain(&evicted);
+}
+
+TEST(IntrusiveLruCache, ReinsertingAnEntryTouchesIt) {
+  IntrusiveLruCache<int, Page> cache(2, 100);
+  Page a(1, 30), b(2, 30), c(3, 30);
+  LinkedList<Page> evicted;
+  cache.Insert(&a, &evicted);
+  cache.Insert(&b, &evicted);
+  cache.Insert(&a, &evicted);
+  EXPECT_TRUE(evicted.Empty());
+  EXPECT_EQ((std::vector<int>{1, 2}), Keys(cache.Entries()));
+  EXPECT_EQ(2u, cache.Size());
+  EXPECT_EQ(60u, cache.Bytes());
+
+  cache.Insert(&c, &evicted);
+  EXPECT_EQ((std::vector<int>{2}), Drain(&evicted));
+  cache.Clear(&evicted);
+  EXPECT_EQ((std::vector<int>{1, 3}), Drain(&evicted));
+
+  // a cache of no entries keeps none
+  IntrusiveLruCache<int, Page> none(0);
+  none.Insert(&a, &evicted);
+  EXPECT_EQ((std::vector<int>{1}), Drain(&evicted));
+  EXPECT_TRUE(none.Empty());
+}
+
+TEST(IntrusiveLruCache, BoundsBytesAlone) {
+  IntrusiveLruCache<int, Page> cache(std::numeric_limits<std::size_t>::max(),
+                                     1000);
+  std::deque<Page> pages;
+  for (int key = 0; key < 200; ++key) pages.emplace_back(key, 10);
+  LinkedList<Page> evicted;
+  // the index grows past its first size
+  for (Page& page : pages) cache.Insert(&page, &evicted);
+  EXPECT_EQ(100u, cache.Size());
+  EXPECT_EQ(1000u, cache.Bytes());
+  EXPECT_EQ(100u, Drain(&evicted).size());
+  for (int key = 0; key < 200; ++key) {
+    EXPECT_EQ(key < 100 ? nullptr : &pages[key], cache.Peek(key)) << key;
+  }
+  cache.Clear(&evicted);
+  Drain(&evicted);
+}
+
+// all keys probe from two slots
+struct CollidingHash {
+  std::size_t operator()(int key) const { return key % 2; }
+};
+
+TEST(IntrusiveLruCache, KeepsProbeChainsWhenErasing) {
+  IntrusiveLruCache<int, Page, CollidingHash> cache(8);
+  std::deque<Page> pages;
+  for (int key = 0; key < 8; ++key) pages.emplace_back(key);
+  LinkedList<Page> evicted;
+  for (Page& page : pages) cache.Insert(&page, &evicted);
+
+  for (int key : {0, 3, 4}) EXPECT_EQ(&pages[key], cache.Erase(key));
+  for (int key = 0; key < 8; ++key) {
+    const bool erased = key == 0 || key == 3 || key == 4;
+    EXPECT_EQ(erased ? nullptr : &pages[key], cache.Peek(key)) << key;
+  }
+  cache.Insert(&pages[3], &evicted);
+  EXPECT_EQ(&pages[3], cache.Find(3));
+  EXPECT_EQ(6u, cache.Size());
+  EXPECT_TRUE(evicted.Empty());
+  cache.Clear(&evicted);
+  Drain(&evicted);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
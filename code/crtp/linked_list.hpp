@@ -75,8 +75,18 @@
 //    needs to glue on the "next" and "previous" pointers using
 //    some internal node type.
 
+#include <cstddef>
+#include <functional>
+#include <utility>
+
 namespace cpp_idioms {
 
+template <typename T>
+class LinkedList;
+
+template <typename T>
+class MpscQueue;
+
 template <typename T>
 class LinkNode {
  public:
@@ -143,6 +153,11 @@ class LinkNode {
   T* Value() { return static_cast<T*>(this); }
 
  private:
+  // cuts ranges of nodes out of lists
+  friend class LinkedList<T>;
+  // links nodes through next_ while they are queued
+  friend class MpscQueue<T>;
+
   LinkNode<T>* previous_;
   LinkNode<T>* next_;
 };
@@ -168,8 +183,139 @@ class LinkedList {
 
   bool Empty() const { return Head() == End(); }
 
+  // Moves all nodes of |other| to the end of the list, in O(1). |other| is
+  // left empty.
+  void Splice(LinkedList<T>* other) {
+    LinkNode<T>* head = other->TakeAll();
+    if (head) head->InsertBeforeAsList(&root_);
+  }
+
+  // Moves the nodes from |first| to |last|, which follow each other in some
+  // list, to the end of the list, in O(1).
+  void SpliceRange(LinkNode<T>* first, LinkNode<T>* last) {
+    // Close the range into a circular list of its own.
+    first->previous_->next_ = last->next_;
+    last->next_->previous_ = first->previous_;
+    first->previous_ = last;
+    last->next_ = first;
+    first->InsertBeforeAsList(&root_);
+  }
+
+  // Removes all nodes and returns them as a circular list without a root,
+  // for LinkNode::InsertBeforeAsList() and InsertAfterAsList(), or NULL if
+  // the list is empty.
+  LinkNode<T>* TakeAll() {
+    if (Empty()) return nullptr;
+    LinkNode<T>* head = Head();
+    root_.RemoveFromList();
+    return head;
+  }
+
+  // Moves the nodes of |other| into the list, both sorted by |comp|, so that
+  // the list stays sorted. Of nodes that compare equal, those of the list
+  // come first.
+  template <typename Compare>
+  void Merge(LinkedList<T>* other, Compare comp) {
+    LinkNode<T>* node = Head();
+    while (!other->Empty()) {
+      LinkNode<T>* first = other->Head();
+      while (node != &root_ && !comp(*first->Value(), *node->Value())) {
+        node = node->Next();
+      }
+      if (node == &root_) {
+        Splice(other);
+        return;
+      }
+      first->RemoveFromList();
+      first->InsertBefore(node);
+    }
+  }
+
+  // Sorts the nodes by |comp|, which compares two const T&, keeping the order
+  // of nodes that compare equal. A merge sort that relinks the nodes in
+  // O(n log n) and does not allocate.
+  template <typename Compare = std::less<T>>
+  void Sort(Compare comp = Compare()) {
+    // As std::list::sort of libstdc++: runs[i] is empty or holds a sorted
+    // run of 2^i nodes, which came before the nodes of runs[i - 1].
+    LinkedList<T> carry;
+    LinkedList<T> runs[64];
+    int used = 0;
+    while (!Empty()) {
+      carry.SpliceRange(Head(), Head());
+      int i = 0;
+      for (; i < used && !runs[i].Empty(); ++i) {
+        runs[i].Merge(&carry, comp);
+        carry.Splice(&runs[i]);
+      }
+      runs[i].Splice(&carry);
+      if (i == used) ++used;
+    }
+    for (int i = 1; i < used; ++i) runs[i].Merge(&runs[i - 1], comp);
+    if (used) Splice(&runs[used - 1]);
+  }
+
  private:
   LinkNode<T> root_;
 };
 
+// A LinkedList that counts its nodes, for Size() in O(1). Nodes must join
+// and leave it through its methods rather than through LinkNode's.
+template <typename T>
+class SizedLinkedList {
+ public:
+  SizedLinkedList() : size_(0) {}
+  SizedLinkedList(const SizedLinkedList&) = delete;
+  SizedLinkedList& operator=(SizedLinkedList&) = delete;
+
+  void Append(LinkNode<T>* e) {
+    list_.Append(e);
+    ++size_;
+  }
+
+  // Removes |e|, which is in the list.
+  void Remove(LinkNode<T>* e) {
+    e->RemoveFromList();
+    --size_;
+  }
+
+  void Splice(SizedLinkedList<T>* other) {
+    list_.Splice(&other->list_);
+    size_ += std::exchange(other->size_, 0);
+  }
+
+  // Moves the |count| nodes from |first| to |last| of |other| to the end of
+  // the list.
+  void SpliceRange(SizedLinkedList<T>* other, LinkNode<T>* first,
+                   LinkNode<T>* last, std::size_t count) {
+    list_.SpliceRange(first, last);
+    other->size_ -= count;
+    size_ += count;
+  }
+
+  LinkNode<T>* TakeAll() {
+    size_ = 0;
+    return list_.TakeAll();
+  }
+
+  template <typename Compare = std::less<T>>
+  void Sort(Compare comp = Compare()) {
+    list_.Sort(comp);
+  }
+
+  LinkNode<T>* Head() const { return list_.Head(); }
+
+  LinkNode<T>* Tail() const { return list_.Tail(); }
+
+  const LinkNode<T>* End() const { return list_.End(); }
+
+  bool Empty() const { return size_ == 0; }
+
+  std::size_t Size() const { return size_; }
+
+ private:
+  LinkedList<T> list_;
+  std::size_t size_;
+};
+
 }  // namespace cpp_idioms
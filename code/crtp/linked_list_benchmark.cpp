@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "linked_list.hpp"
+
+namespace {
+
+using cpp_idioms::LinkedList;
+using cpp_idioms::LinkNode;
+
+class Task : public LinkNode<Task> {
+ public:
+  explicit Task(int priority) : priority(priority) {}
+
+  int priority;
+};
+
+bool ByPriority(const Task& a, const Task& b) {
+  return a.priority < b.priority;
+}
+
+std::deque<Task> MakeTasks(int n) {
+  std::mt19937 random(42);
+  std::deque<Task> tasks;
+  for (int i = 0; i < n; ++i) tasks.emplace_back(random() % 1000);
+  return tasks;
+}
+
+// Hand a run queue of state.range(0) tasks to another queue and back, one
+// node at a time.
+void BM_HandOffByNode(benchmark::State& state) {
+  std::deque<Task> tasks = MakeTasks(state.range(0));
+  LinkedList<Task> from, to;
+  for (Task& task : tasks) from.Append(&task);
+  for (auto _ : state) {
+    while (!from.Empty()) {
+      LinkNode<Task>* node = from.Head();
+      node->RemoveFromList();
+      to.Append(node);
+    }
+    while (!to.Empty()) {
+      LinkNode<Task>* node = to.Head();
+      node->RemoveFromList();
+      from.Append(node);
+    }
+  }
+}
+BENCHMARK(BM_HandOffByNode)->Range(1 << 4, 1 << 16);
+
+// The same with Splice().
+void BM_HandOffBySplice(benchmark::State& state) {
+  std::deque<Task> tasks = MakeTasks(state.range(0));
+  LinkedList<Task> from, to;
+  for (Task& task : tasks) from.Append(&task);
+  for (auto _ : state) {
+    to.Splice(&from);
+    from.Splice(&to);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_HandOffBySplice)->Range(1 << 4, 1 << 16);
+
+// Sort a run queue by priority, relinking its nodes.
+void BM_LinkedListSort(benchmark::State& state) {
+  std::deque<Task> tasks = MakeTasks(state.range(0));
+  std::vector<int> priorities;
+  for (const Task& task : tasks) priorities.push_back(task.priority);
+  LinkedList<Task> queue;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].priority = priorities[i];
+      queue.Append(&tasks[i]);
+    }
+    state.ResumeTiming();
+    queue.Sort(ByPriority);
+    state.PauseTiming();
+    while (!queue.Empty()) queue.Head()->RemoveFromList();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_LinkedListSort)->Range(1 << 10, 1 << 16);
+
+// What sorting cost without Sort(): the node pointers into a vector,
+// std::stable_sort and relinking.
+void BM_VectorSortAndRelink(benchmark::State& state) {
+  std::deque<Task> tasks = MakeTasks(state.range(0));
+  std::vector<int> priorities;
+  for (const Task& task : tasks) priorities.push_back(task.priority);
+  LinkedList<Task> queue;
+  std::vector<Task*> sorted;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].priority = priorities[i];
+      queue.Append(&tasks[i]);
+    }
+    sorted.clear();
+    sorted.shrink_to_fit();
+    state.ResumeTiming();
+    while (!queue.Empty()) {
+      LinkNode<Task>* node = queue.Head();
+      node->RemoveFromList();
+      sorted.push_back(node->Value());
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Task* a, const Task* b) {
+                       return ByPriority(*a, *b);
+                     });
+    for (Task* task : sorted) queue.Append(task);
+    state.PauseTiming();
+    while (!queue.Empty()) queue.Head()->RemoveFromList();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_VectorSortAndRelink)->Range(1 << 10, 1 << 16);
+
+}  // namespace
@@ -6,6 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <vector>
+
 #include "utils/macros.hpp"
 
 namespace cpp_idioms {
@@ -304,5 +307,193 @@ TEST(LinkedList, RemovedNodeHasNullNextPrevious) {
   EXPECT_EQ(&n, n.Previous());
 }
 
+TEST(LinkedList, Splice) {
+  LinkedList<Node> list1;
+  LinkedList<Node> list2;
+
+  Node n1(1);
+  Node n2(2);
+  Node n3(3);
+  Node n4(4);
+
+  // Splicing an empty list changes nothing.
+  list1.Splice(&list2);
+  ExpectListContents(list1, 0, nullptr);
+
+  list1.Append(&n1);
+  list2.Append(&n2);
+  list2.Append(&n3);
+  list1.Splice(&list2);
+  {
+    const int expected[] = {1, 2, 3};
+    ExpectListContents(list1, arraysize(expected), expected);
+  }
+  EXPECT_TRUE(list2.Empty());
+
+  // Into an empty list, and back.
+  list2.Splice(&list1);
+  list2.Append(&n4);
+  {
+    const int expected[] = {1, 2, 3, 4};
+    ExpectListContents(list2, arraysize(expected), expected);
+  }
+  EXPECT_TRUE(list1.Empty());
+}
+
+TEST(LinkedList, SpliceRange) {
+  LinkedList<Node> list1;
+  LinkedList<Node> list2;
+
+  Node n1(1);
+  Node n2(2);
+  Node n3(3);
+  Node n4(4);
+  Node n5(5);
+
+  list1.Append(&n1);
+  list1.Append(&n2);
+  list1.Append(&n3);
+  list1.Append(&n4);
+  list2.Append(&n5);
+
+  // From the middle of another list.
+  list2.SpliceRange(&n2, &n3);
+  {
+    const int expected[] = {1, 4};
+    ExpectListContents(list1, arraysize(expected), expected);
+  }
+  {
+    const int expected[] = {5, 2, 3};
+    ExpectListContents(list2, arraysize(expected), expected);
+  }
+
+  // A single node, from the head of the same list.
+  list2.SpliceRange(&n5, &n5);
+  {
+    const int expected[] = {2, 3, 5};
+    ExpectListContents(list2, arraysize(expected), expected);
+  }
+
+  // A whole list.
+  list2.SpliceRange(list1.Head(), list1.Tail());
+  ExpectListContents(list1, 0, nullptr);
+  {
+    const int expected[] = {2, 3, 5, 1, 4};
+    ExpectListContents(list2, arraysize(expected), expected);
+  }
+}
+
+TEST(LinkedList, TakeAll) {
+  LinkedList<Node> list;
+  EXPECT_EQ(nullptr, list.TakeAll());
+
+  Node n1(1);
+  Node n2(2);
+  Node n3(3);
+
+  list.Append(&n1);
+  list.Append(&n2);
+  LinkNode<Node>* nodes = list.TakeAll();
+  EXPECT_EQ(&n1, nodes);
+  EXPECT_TRUE(list.Empty());
+
+  // The nodes form a circular list without a root.
+  EXPECT_EQ(&n2, n1.Next());
+  EXPECT_EQ(&n1, n2.Next());
+
+  list.Append(&n3);
+  nodes->InsertAfterAsList(&n3);
+  {
+    const int expected[] = {3, 1, 2};
+    ExpectListContents(list, arraysize(expected), expected);
+  }
+}
+
+TEST(LinkedList, Sort) {
+  LinkedList<Node> list;
+  list.Sort([](const Node&, const Node&) { return false; });
+  ExpectListContents(list, 0, nullptr);
+
+  const int ids[] = {42, 7, 13, 7, 0, 99, 1, 13, 8, 64, 5};
+  std::vector<std::unique_ptr<Node>> nodes;
+  for (int id : ids) {
+    nodes.push_back(std::make_unique<Node>(id));
+    list.Append(nodes.back().get());
+  }
+
+  list.Sort([](const Node& a, const Node& b) { return a.Id() < b.Id(); });
+  {
+    const int expected[] = {0, 1, 5, 7, 7, 8, 13, 13, 42, 64, 99};
+    ExpectListContents(list, arraysize(expected), expected);
+  }
+  // Equal nodes keep their order.
+  EXPECT_EQ(nodes[1].get(), list.Head()->Next()->Next()->Next());
+
+  list.Sort(
+      [](const Node& a, const Node& b) { return a.Id() % 2 < b.Id() % 2; });
+  {
+    const int expected[] = {0, 8, 42, 64, 1, 5, 7, 7, 13, 13, 99};
+    ExpectListContents(list, arraysize(expected), expected);
+  }
+}
+
+TEST(LinkedList, SortManyNodes) {
+  LinkedList<Node> list;
+  std::vector<std::unique_ptr<Node>> nodes;
+  for (int i = 0; i < 10000; ++i) {
+    nodes.push_back(std::make_unique<Node>(i * 7919 % 10007));
+    list.Append(nodes.back().get());
+  }
+  list.Sort([](const Node& a, const Node& b) { return a.Id() < b.Id(); });
+
+  int count = 0;
+  int previous = -1;
+  for (LinkNode<Node>* node = list.Head(); node != list.End();
+       node = node->Next()) {
+    EXPECT_LT(previous, node->Value()->Id());
+    EXPECT_EQ(node, node->Next()->Previous());
+    previous = node->Value()->Id();
+    ++count;
+  }
+  EXPECT_EQ(10000, count);
+}
+
+TEST(LinkedList, SizedLinkedList) {
+  SizedLinkedList<Node> list1;
+  SizedLinkedList<Node> list2;
+  EXPECT_EQ(0u, list1.Size());
+  EXPECT_TRUE(list1.Empty());
+
+  Node n1(1);
+  Node n2(2);
+  Node n3(3);
+  Node n4(4);
+
+  list1.Append(&n1);
+  list1.Append(&n2);
+  list1.Append(&n3);
+  list2.Append(&n4);
+  EXPECT_EQ(3u, list1.Size());
+
+  list2.SpliceRange(&list1, &n1, &n2, 2);
+  EXPECT_EQ(1u, list1.Size());
+  EXPECT_EQ(3u, list2.Size());
+  EXPECT_EQ(&n4, list2.Head());
+  EXPECT_EQ(&n2, list2.Tail());
+
+  list1.Splice(&list2);
+  EXPECT_EQ(4u, list1.Size());
+  EXPECT_EQ(0u, list2.Size());
+
+  list1.Remove(&n4);
+  list1.Sort([](const Node& a, const Node& b) { return a.Id() > b.Id(); });
+  EXPECT_EQ(3u, list1.Size());
+  EXPECT_EQ(&n3, list1.Head());
+  EXPECT_EQ(&n1, list1.Tail());
+
+  EXPECT_EQ(&n3, list1.TakeAll());
+  EXPECT_TRUE(list1.Empty());
+}
+
 }  // namespace
 }  // namespace cpp_idioms
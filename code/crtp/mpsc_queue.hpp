@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+
+#include "linked_list.hpp"
+
+// An intrusive multi-producer single-consumer queue, after Dmitry Vyukov's
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+//
+// Elements extend LinkNode like those of LinkedList, and the queue links
+// them through the same next pointer, so pushing and popping never
+// allocate:
+//
+//   class Work : public LinkNode<Work> { ... };
+//
+//   MpscQueue<Work> queue;
+//   queue.Push(work);                    // any thread
+//   while (Work* work = queue.Pop()) {   // one thread
+//     ...
+//   }
+//
+// Push() is wait-free, one atomic exchange. Pop() is lock-free for the
+// consumer, but returns nullptr while the producer of the next element is
+// between its exchange and linking the element; the element shows up once
+// that producer continues.
+//
+// A node must not be in any list while it is queued. Popped nodes are
+// self-referential again, so they can go into a LinkedList right away. The
+// queue does not own its nodes.
+
+namespace cpp_idioms {
+
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) { stub_.next_ = nullptr; }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Any thread.
+  void Push(LinkNode<T>* node) {
+    node->previous_ = node;
+    StoreNext(node, nullptr);
+    LinkNode<T>* previous = head_.exchange(node, std::memory_order_acq_rel);
+    // until here the node is unreachable from tail_, see Pop()
+    StoreNext(previous, node);
+  }
+
+  // The consumer only. The oldest element, or nullptr if there is none or
+  // it is still being pushed.
+  T* Pop() {
+    LinkNode<T>* tail = tail_;
+    LinkNode<T>* next = LoadNext(tail);
+    if (tail == &stub_) {
+      if (!next) return nullptr;
+      tail_ = tail = next;
+      next = LoadNext(next);
+    }
+    if (next) {
+      tail_ = next;
+      return Detach(tail);
+    }
+    // tail is the last node linked; it can only go once a node follows it
+    if (tail != head_.load(std::memory_order_acquire)) return nullptr;
+    Push(&stub_);
+    next = LoadNext(tail);
+    if (next) {
+      tail_ = next;
+      return Detach(tail);
+    }
+    return nullptr;
+  }
+
+  // The consumer only. Whether nothing was pushed that has not been popped.
+  bool Empty() const {
+    return tail_ == &stub_ && head_.load(std::memory_order_acquire) == &stub_;
+  }
+
+ private:
+  // The next pointer of a LinkNode is a plain pointer, and C++17 has no
+  // std::atomic_ref, so access it with the builtins of GCC and Clang.
+  static LinkNode<T>* LoadNext(LinkNode<T>* node) {
+    return __atomic_load_n(&node->next_, __ATOMIC_ACQUIRE);
+  }
+
+  static void StoreNext(LinkNode<T>* node, LinkNode<T>* next) {
+    __atomic_store_n(&node->next_, next, __ATOMIC_RELEASE);
+  }
+
+  static T* Detach(LinkNode<T>* node) {
+    node->next_ = node;
+    node->previous_ = node;
+    return node->Value();
+  }
+
+  // Stands in for an element so that the queue never runs empty, which
+  // would make producers and the consumer touch the same pointer.
+  LinkNode<T> stub_;
+  // the newest node, where producers push
+  alignas(64) std::atomic<LinkNode<T>*> head_;
+  // the oldest node, where the consumer pops
+  alignas(64) LinkNode<T>* tail_;
+};
+
+}  // namespace cpp_idioms
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.hpp"
+
+namespace {
+
+using cpp_idioms::LinkedList;
+using cpp_idioms::LinkNode;
+using cpp_idioms::MpscQueue;
+
+class Item : public LinkNode<Item> {};
+
+// The queue MpscQueue replaces: a LinkedList behind a mutex.
+class MutexQueue {
+ public:
+  void Push(LinkNode<Item>* node) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list_.Append(node);
+  }
+
+  Item* Pop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (list_.Empty()) return nullptr;
+    LinkNode<Item>* node = list_.Head();
+    node->RemoveFromList();
+    return node->Value();
+  }
+
+ private:
+  std::mutex mutex_;
+  LinkedList<Item> list_;
+};
+
+constexpr int kItemsPerProducer = 1 << 16;
+
+// state.range(0) producers push kItemsPerProducer items each while the
+// benchmark thread pops them all.
+template <typename Queue>
+void BM_Transfer(benchmark::State& state) {
+  const int producers = state.range(0);
+  std::vector<std::deque<Item>> items(producers);
+  for (std::deque<Item>& own : items) own.resize(kItemsPerProducer);
+  Queue queue;
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    for (std::deque<Item>& own : items) {
+      threads.emplace_back([&queue, &own] {
+        for (Item& item : own) queue.Push(&item);
+      });
+    }
+    for (int popped = 0; popped < producers * kItemsPerProducer;) {
+      if (queue.Pop()) {
+        ++popped;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    for (std::thread& thread : threads) thread.join();
+  }
+  state.SetItemsProcessed(state.iterations() * producers * kItemsPerProducer);
+}
+BENCHMARK_TEMPLATE(BM_Transfer, MutexQueue)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Transfer, MpscQueue<Item>)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+}  // namespace
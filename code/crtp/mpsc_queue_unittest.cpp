@@ -0,0 +1,101 @@
+#include "mpsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+class Item : public LinkNode<Item> {
+ public:
+  Item(int producer, int sequence)
+      : producer_(producer), sequence_(sequence) {}
+
+  int Producer() const { return producer_; }
+  int Sequence() const { return sequence_; }
+
+ private:
+  int producer_;
+  int sequence_;
+};
+
+TEST(MpscQueue, PopsInPushOrder) {
+  MpscQueue<Item> queue;
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(nullptr, queue.Pop());
+
+  Item items[3] = {{0, 1}, {0, 2}, {0, 3}};
+  for (Item& item : items) queue.Push(&item);
+  EXPECT_FALSE(queue.Empty());
+  EXPECT_EQ(&items[0], queue.Pop());
+  EXPECT_EQ(&items[1], queue.Pop());
+
+  // popped nodes can be pushed again
+  queue.Push(&items[0]);
+  EXPECT_EQ(&items[2], queue.Pop());
+  EXPECT_EQ(&items[0], queue.Pop());
+  EXPECT_EQ(nullptr, queue.Pop());
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MpscQueue, PoppedNodesFitIntoLinkedLists) {
+  MpscQueue<Item> queue;
+  Item a(0, 1), b(0, 2);
+  queue.Push(&a);
+  queue.Push(&b);
+  LinkedList<Item> list;
+  while (Item* item = queue.Pop()) {
+    EXPECT_EQ(item, item->Next());
+    EXPECT_EQ(item, item->Previous());
+    list.Append(item);
+  }
+  EXPECT_EQ(&a, list.Head());
+  EXPECT_EQ(&b, list.Tail());
+  a.RemoveFromList();
+  b.RemoveFromList();
+  EXPECT_TRUE(list.Empty());
+}
+
+// Run under TSan too.
+TEST(MpscQueue, KeepsTheOrderOfEachProducer) {
+  constexpr int kProducers = 4;
+  constexpr int kItems = 50000;
+  // a deque never moves its elements, which LinkNodes cannot be
+  std::vector<std::deque<Item>> items(kProducers);
+  for (int p = 0; p < kProducers; ++p) {
+    for (int i = 0; i < kItems; ++i) items[p].emplace_back(p, i);
+  }
+
+  MpscQueue<Item> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, &items, p] {
+      for (Item& item : items[p]) queue.Push(&item);
+    });
+  }
+  std::vector<int> next(kProducers, 0);
+  for (int popped = 0; popped < kProducers * kItems;) {
+    Item* item = queue.Pop();
+    if (!item) {
+      std::this_thread::yield();
+      continue;
+    }
+    // not ASSERT_EQ, which would return with the producers still joinable
+    if (next[item->Producer()]++ != item->Sequence()) {
+      ADD_FAILURE() << "producer " << item->Producer() << " item "
+                    << item->Sequence() << " out of order";
+      break;
+    }
+    ++popped;
+  }
+  for (std::thread& producer : producers) producer.join();
+  EXPECT_EQ(std::vector<int>(kProducers, kItems), next);
+  EXPECT_EQ(nullptr, queue.Pop());
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace cpp_idioms
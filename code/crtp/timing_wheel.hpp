@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "linked_list.hpp"
+
+namespace cpp_idioms {
+
+template <typename T, int Bits = 6, int Levels = 6>
+class TimingWheel;
+
+// The base of the timers of a TimingWheel<T>, which is a LinkNode<T> for
+// the bucket the timer is in and holds its expiry.
+template <typename T>
+class TimerNode : public LinkNode<T> {
+ public:
+  // The tick the timer expires at
+  std::uint64_t Expiry() const { return expiry_; }
+
+  // Whether the timer is in a wheel and has not expired yet
+  bool Scheduled() const { return this->Next() != this; }
+
+ private:
+  template <typename, int, int>
+  friend class TimingWheel;
+
+  std::uint64_t expiry_ = 0;
+};
+
+// A hierarchical timing wheel, after Varghese and Lauck, of timers that
+// extend TimerNode<T>.
+//
+//   class Connection : public TimerNode<Connection> { ... };
+//
+//   TimingWheel<Connection> timeouts;
+//   timeouts.Schedule(connection, now + kIdleTicks);
+//   ...
+//   timeouts.Cancel(connection);
+//   ...
+//   timeouts.Advance(now, [](Connection* c) { c->Close(); });
+//
+// Level k has 2^Bits buckets of 2^(Bits * k) ticks each; a timer goes into
+// the lowest level whose range covers it. Buckets are LinkedLists through
+// the timers themselves, so scheduling is O(1) and cancelling is
+// RemoveFromList() without a lookup, and neither allocates. When a lower
+// level wraps around, the next bucket of the level above is spliced out as
+// a whole and its timers are spread over the levels below. Timers further
+// out than 2^(Bits * Levels) ticks, 2^36 by default, wait in the top level.
+//
+// Advance() jumps from one tick with a bucket due to the next, so that the
+// ticks in between, e.g. until a far timer, cost nothing. The wheel does not
+// own its timers.
+template <typename T, int Bits, int Levels>
+class TimingWheel {
+  static_assert(Bits > 0 && Levels > 0 && Bits * Levels < 64,
+                "The range of the wheel, 2^(Bits * Levels) ticks, must fit "
+                "into a std::uint64_t");
+
+ public:
+  static constexpr int kBits = Bits;
+  static constexpr int kLevels = Levels;
+  static constexpr std::size_t kBuckets = std::size_t{1} << kBits;
+
+  explicit TimingWheel(std::uint64_t now = 0) : now_(now), size_(0) {}
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  // Schedule timer to expire at tick expiry, at the earliest on the next
+  // tick. A scheduled timer is rescheduled.
+  void Schedule(TimerNode<T>* timer, std::uint64_t expiry) {
+    if (timer->Scheduled()) {
+      timer->RemoveFromList();
+    } else {
+      ++size_;
+    }
+    timer->expiry_ = expiry > now_ ? expiry : now_ + 1;
+    Place(static_cast<T*>(timer));
+  }
+
+  // Whether timer was scheduled. Works from within Advance() too.
+  bool Cancel(TimerNode<T>* timer) {
+    if (!timer->Scheduled()) return false;
+    timer->RemoveFromList();
+    --size_;
+    return true;
+  }
+
+  // Move the time forward to now and call on_expire(T*) for each timer that
+  // expires, in the order of their expiry. on_expire may schedule and
+  // cancel timers, but not call Advance(). Returns how many expired.
+  //
+  // If on_expire throws, the time stays at the tick of the timer it threw
+  // for, and the timers still due at that tick stay scheduled. The next
+  // Advance() expires them first.
+  template <typename F>
+  std::size_t Advance(std::uint64_t now, F&& on_expire) {
+    std::size_t expired = Expire(on_expire);
+    while (now_ < now) {
+      const std::uint64_t due = size_ == 0 ? now : NextDue();
+      now_ = due < now ? due : now;
+      Cascade();
+      expired_.Splice(&buckets_[0][now_ & kMask]);
+      expired += Expire(on_expire);
+    }
+    return expired;
+  }
+
+  std::uint64_t Now() const { return now_; }
+
+  // The number of scheduled timers
+  std::size_t Size() const { return size_; }
+
+ private:
+  static constexpr std::uint64_t kMask = kBuckets - 1;
+
+  // Put timer, whose expiry is not before now_, into its bucket.
+  void Place(T* timer) {
+    std::uint64_t expiry = timer->expiry_;
+    const std::uint64_t delta = expiry - now_;
+    int level = 0;
+    while (level < kLevels - 1 && delta >> (kBits * (level + 1))) ++level;
+    if (level == kLevels - 1 && delta >> (kBits * kLevels)) {
+      // out of range: wait in the farthest bucket, and move on from there
+      expiry = now_ + (std::uint64_t{1} << (kBits * kLevels)) - 1;
+    }
+    buckets_[level][(expiry >> (kBits * level)) & kMask].Append(timer);
+  }
+
+  // Pass the timers in expired_, which are due at now_, to on_expire.
+  template <typename F>
+  std::size_t Expire(F& on_expire) {
+    std::size_t expired = 0;
+    while (!expired_.Empty()) {
+      LinkNode<T>* timer = expired_.Head();
+      timer->RemoveFromList();
+      --size_;
+      ++expired;
+      on_expire(timer->Value());
+    }
+    return expired;
+  }
+
+  // The first tick after now_ with a bucket due, or the maximum if none is.
+  // Level k takes its next bucket every 2^(kBits * k) ticks. A timer waits
+  // in it for less than a round of kBuckets buckets, so the next bucket of
+  // the level that is due is among the next round.
+  std::uint64_t NextDue() const {
+    std::uint64_t due = std::numeric_limits<std::uint64_t>::max();
+    for (int level = 0; level < kLevels; ++level) {
+      const int shift = kBits * level;
+      std::uint64_t tick = ((now_ >> shift) + 1) << shift;
+      for (std::size_t i = 0; i < kBuckets && tick < due;
+           ++i, tick += std::uint64_t{1} << shift) {
+        if (!buckets_[level][(tick >> shift) & kMask].Empty()) due = tick;
+      }
+    }
+    return due;
+  }
+
+  // Spread the timers of the buckets of the levels above 0 that are due at
+  // now_ over the levels below.
+  void Cascade() {
+    for (int level = 1; level < kLevels; ++level) {
+      const int shift = kBits * level;
+      // the levels below have not wrapped around
+      if (now_ & ((std::uint64_t{1} << shift) - 1)) return;
+      cascading_.Splice(&buckets_[level][(now_ >> shift) & kMask]);
+      while (!cascading_.Empty()) {
+        LinkNode<T>* timer = cascading_.Head();
+        timer->RemoveFromList();
+        Place(timer->Value());
+      }
+    }
+  }
+
+  std::uint64_t now_;
+  std::size_t size_;
+  std::array<std::array<LinkedList<T>, kBuckets>, kLevels> buckets_;
+  // timers Advance() is about to pass to on_expire
+  LinkedList<T> expired_;
+  // timers Cascade() is about to place again
+  LinkedList<T> cascading_;
+};
+
+}  // namespace cpp_idioms
@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "timing_wheel.hpp"
+
+namespace {
+
+using cpp_idioms::TimerNode;
+using cpp_idioms::TimingWheel;
+
+constexpr int kTimers = 1000000;
+// connection timeouts of up to about a minute in milliseconds
+constexpr std::uint64_t kMaxDelay = 1 << 16;
+
+class Timer : public TimerNode<Timer> {
+ public:
+  // for MapTimers
+  std::multimap<std::uint64_t, Timer*>::iterator entry;
+  bool scheduled = false;
+};
+
+// The ordered map of expiries TimingWheel replaces. Timers keep their
+// iterator, so that cancelling needs no search.
+class MapTimers {
+ public:
+  void Schedule(Timer* timer, std::uint64_t expiry) {
+    Cancel(timer);
+    timer->entry = timers_.emplace(expiry > now_ ? expiry : now_ + 1, timer);
+    timer->scheduled = true;
+  }
+
+  bool Cancel(Timer* timer) {
+    if (!timer->scheduled) return false;
+    timers_.erase(timer->entry);
+    timer->scheduled = false;
+    return true;
+  }
+
+  template <typename F>
+  std::size_t Advance(std::uint64_t now, F&& on_expire) {
+    std::size_t expired = 0;
+    now_ = now;
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+      Timer* timer = timers_.begin()->second;
+      timers_.erase(timers_.begin());
+      timer->scheduled = false;
+      ++expired;
+      on_expire(timer);
+    }
+    return expired;
+  }
+
+  std::uint64_t Now() const { return now_; }
+
+ private:
+  std::uint64_t now_ = 0;
+  std::multimap<std::uint64_t, Timer*> timers_;
+};
+
+// kTimers timers are active. Each iteration reschedules one, as traffic on
+// a connection does, and every 16th moves the time one tick on and
+// reschedules the timers that expire.
+template <typename Timers>
+void BM_Reschedule(benchmark::State& state) {
+  std::mt19937_64 random(42);
+  std::deque<Timer> timers(kTimers);
+  Timers wheel;
+  for (Timer& timer : timers) {
+    wheel.Schedule(&timer, 1 + random() % kMaxDelay);
+  }
+  std::vector<std::uint32_t> picks(1 << 20);
+  for (std::uint32_t& pick : picks) pick = random() % kTimers;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    Timer& timer = timers[picks[i & (picks.size() - 1)]];
+    wheel.Schedule(&timer, wheel.Now() + 1 + (i * 7919) % kMaxDelay);
+    if (++i % 16 == 0) {
+      wheel.Advance(wheel.Now() + 1, [&](Timer* expired) {
+        wheel.Schedule(expired, wheel.Now() + kMaxDelay);
+      });
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Reschedule, MapTimers);
+BENCHMARK_TEMPLATE(BM_Reschedule, TimingWheel<Timer>);
+
+// Schedule kTimers timers and let all of them expire.
+template <typename Timers>
+void BM_ScheduleAndExpire(benchmark::State& state) {
+  std::mt19937_64 random(42);
+  std::deque<Timer> timers(kTimers);
+  std::vector<std::uint64_t> delays(kTimers);
+  for (std::uint64_t& delay : delays) delay = 1 + random() % kMaxDelay;
+  for (auto _ : state) {
+    Timers wheel;
+    for (int i = 0; i < kTimers; ++i) wheel.Schedule(&timers[i], delays[i]);
+    std::size_t expired = wheel.Advance(kMaxDelay, [](Timer*) {});
+    benchmark::DoNotOptimize(expired);
+  }
+  state.SetItemsProcessed(state.iterations() * kTimers);
+}
+BENCHMARK_TEMPLATE(BM_ScheduleAndExpire, MapTimers)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ScheduleAndExpire, TimingWheel<Timer>)
+    ->Unit(benchmark::kMillisecond);
+
+// A few timers spread over about 12 days in milliseconds, e.g. session
+// expiries, all of which expire in one Advance().
+template <typename Timers>
+void BM_ExpireSparse(benchmark::State& state) {
+  constexpr int kSparseTimers = 1000;
+  std::mt19937_64 random(42);
+  std::deque<Timer> timers(kSparseTimers);
+  std::vector<std::uint64_t> delays(kSparseTimers);
+  for (std::uint64_t& delay : delays) delay = 1 + random() % (1 << 30);
+  for (auto _ : state) {
+    Timers wheel;
+    for (int i = 0; i < kSparseTimers; ++i) {
+      wheel.Schedule(&timers[i], delays[i]);
+    }
+    std::size_t expired = wheel.Advance(1 << 30, [](Timer*) {});
+    benchmark::DoNotOptimize(expired);
+  }
+  state.SetItemsProcessed(state.iterations() * kSparseTimers);
+}
+BENCHMARK_TEMPLATE(BM_ExpireSparse, MapTimers);
+BENCHMARK_TEMPLATE(BM_ExpireSparse, TimingWheel<Timer>);
+
+}  // namespace
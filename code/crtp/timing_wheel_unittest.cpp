@@ -0,0 +1,201 @@
+#include "timing_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+class Timer : public TimerNode<Timer> {
+ public:
+  explicit Timer(int id) : id_(id) {}
+
+  int Id() const { return id_; }
+
+ private:
+  int id_;
+};
+
+// Advances wheel to now and returns the ids and ticks of the timers that
+// expired.
+std::vector<std::pair<int, std::uint64_t>> AdvanceTo(TimingWheel<Timer>* wheel,
+                                                     std::uint64_t now) {
+  std::vector<std::pair<int, std::uint64_t>> expired;
+  wheel->Advance(now, [&](Timer* timer) {
+    EXPECT_FALSE(timer->Scheduled());
+    expired.emplace_back(timer->Id(), wheel->Now());
+  });
+  return expired;
+}
+
+using Expired = std::vector<std::pair<int, std::uint64_t>>;
+
+TEST(TimingWheel, ExpiresOnTime) {
+  TimingWheel<Timer> wheel(1000);
+  Timer a(1), b(2), c(3), d(4), e(5);
+  wheel.Schedule(&a, 1010);
+  wheel.Schedule(&b, 1005);
+  wheel.Schedule(&c, 1000 + 5000);
+  wheel.Schedule(&d, 1000 + 300000);
+  // in the past: the next tick
+  wheel.Schedule(&e, 10);
+  EXPECT_EQ(5u, wheel.Size());
+  EXPECT_TRUE(a.Scheduled());
+
+  EXPECT_EQ((Expired{{5, 1001}, {2, 1005}}), AdvanceTo(&wheel, 1009));
+  EXPECT_EQ((Expired{{1, 1010}}), AdvanceTo(&wheel, 1010));
+  EXPECT_EQ((Expired{{3, 6000}}), AdvanceTo(&wheel, 300000));
+  EXPECT_EQ((Expired{{4, 301000}}), AdvanceTo(&wheel, 400000));
+  EXPECT_EQ(0u, wheel.Size());
+  EXPECT_FALSE(a.Scheduled());
+
+  // an empty wheel jumps
+  EXPECT_TRUE(AdvanceTo(&wheel, std::uint64_t{1} << 50).empty());
+  EXPECT_EQ(std::uint64_t{1} << 50, wheel.Now());
+}
+
+TEST(TimingWheel, CancelsAndReschedules) {
+  TimingWheel<Timer> wheel;
+  Timer a(1), b(2), c(3);
+  wheel.Schedule(&a, 100);
+  wheel.Schedule(&b, 100);
+  wheel.Schedule(&c, 200);
+  EXPECT_TRUE(wheel.Cancel(&a));
+  EXPECT_FALSE(wheel.Cancel(&a));
+  wheel.Schedule(&c, 50);
+  EXPECT_EQ(2u, wheel.Size());
+  EXPECT_EQ((Expired{{3, 50}, {2, 100}}), AdvanceTo(&wheel, 1000));
+
+  // from within Advance(): b cancels c, which expires on the same tick, and
+  // reschedules itself once
+  wheel.Schedule(&b, 1100);
+  wheel.Schedule(&c, 1100);
+  int runs = 0;
+  wheel.Advance(2000, [&](Timer* timer) {
+    EXPECT_EQ(&b, timer);
+    if (runs++ == 0) {
+      EXPECT_TRUE(wheel.Cancel(&c));
+      wheel.Schedule(&b, wheel.Now() + 1);
+    }
+  });
+  EXPECT_EQ(2, runs);
+  EXPECT_EQ(0u, wheel.Size());
+}
+
+TEST(TimingWheel, JumpsToFarTimers) {
+  TimingWheel<Timer> wheel;
+  Timer a(1), b(2), c(3), d(4);
+  wheel.Schedule(&a, 5);
+  wheel.Schedule(&b, std::uint64_t{1} << 20);
+  wheel.Schedule(&c, (std::uint64_t{1} << 35) + 3);
+  // beyond the range of the wheel
+  wheel.Schedule(&d, std::uint64_t{1} << 45);
+  // stepping tick by tick would not finish
+  EXPECT_EQ((Expired{{1, 5},
+                     {2, std::uint64_t{1} << 20},
+                     {3, (std::uint64_t{1} << 35) + 3},
+                     {4, std::uint64_t{1} << 45}}),
+            AdvanceTo(&wheel, std::uint64_t{1} << 46));
+  EXPECT_EQ(std::uint64_t{1} << 46, wheel.Now());
+}
+
+TEST(TimingWheel, ExpiresTheRestOfATickAfterAThrow) {
+  TimingWheel<Timer> wheel;
+  Timer a(1), b(2), c(3);
+  wheel.Schedule(&a, 10);
+  wheel.Schedule(&b, 10);
+  wheel.Schedule(&c, 11);
+  EXPECT_THROW(wheel.Advance(20,
+                             [](Timer*) {
+                               throw std::runtime_error("on_expire failed");
+                             }),
+               std::runtime_error);
+  EXPECT_EQ(10u, wheel.Now());
+  EXPECT_FALSE(a.Scheduled());
+  EXPECT_TRUE(b.Scheduled());
+  EXPECT_EQ(2u, wheel.Size());
+
+  // b still expires at 10, without the time moving on
+  EXPECT_EQ((Expired{{2, 10}}), AdvanceTo(&wheel, 10));
+  EXPECT_EQ((Expired{{3, 11}}), AdvanceTo(&wheel, 20));
+}
+
+// A wheel of two levels of four buckets covers 16 ticks.
+using TinyWheel = TimingWheel<Timer, 2, 2>;
+
+TEST(TimingWheel, KeepsTimersBeyondItsRange) {
+  TinyWheel wheel;
+  Timer far(1), near(2);
+  wheel.Schedule(&far, 100);
+  wheel.Schedule(&near, 7);
+  std::vector<std::pair<int, std::uint64_t>> expired;
+  wheel.Advance(200, [&](Timer* timer) {
+    expired.emplace_back(timer->Id(), wheel.Now());
+  });
+  EXPECT_EQ((Expired{{2, 7}, {1, 100}}), expired);
+}
+
+// Schedules, cancels and expires timers at random and checks the wheel
+// against a std::multimap of expiries.
+template <typename Wheel>
+void ExpectToMatchAnOrderedMap(std::uint64_t max_delay,
+                               std::uint64_t max_advance) {
+  std::mt19937_64 random(7);
+  std::deque<Timer> timers;
+  for (int i = 0; i < 2000; ++i) timers.emplace_back(i);
+  Wheel wheel(12345);
+  // expiry -> id, for the timers that are scheduled
+  std::multimap<std::uint64_t, int> expected;
+  std::vector<std::multimap<std::uint64_t, int>::iterator> entries(
+      timers.size(), expected.end());
+
+  for (int step = 0; step < 200; ++step) {
+    for (int i = 0; i < 50; ++i) {
+      Timer& timer = timers[random() % timers.size()];
+      if (random() % 4 == 0) {
+        EXPECT_EQ(entries[timer.Id()] != expected.end(), wheel.Cancel(&timer));
+      } else {
+        // delays on all levels
+        const std::uint64_t delay = 1 + (random() >> (random() % 64));
+        wheel.Schedule(&timer, wheel.Now() + delay % max_delay);
+      }
+      if (entries[timer.Id()] != expected.end()) {
+        expected.erase(entries[timer.Id()]);
+        entries[timer.Id()] = expected.end();
+      }
+      if (timer.Scheduled()) {
+        entries[timer.Id()] = expected.emplace(timer.Expiry(), timer.Id());
+      }
+    }
+    ASSERT_EQ(expected.size(), wheel.Size());
+
+    const std::uint64_t now = wheel.Now() + random() % max_advance;
+    wheel.Advance(now, [&](Timer* timer) {
+      ASSERT_FALSE(expected.empty());
+      EXPECT_EQ(expected.begin()->first, wheel.Now());
+      EXPECT_EQ(timer->Expiry(), wheel.Now());
+      EXPECT_NE(entries[timer->Id()], expected.end());
+      expected.erase(entries[timer->Id()]);
+      entries[timer->Id()] = expected.end();
+    });
+    if (!expected.empty()) {
+      EXPECT_GT(expected.begin()->first, now);
+    }
+  }
+}
+
+TEST(TimingWheel, MatchesAnOrderedMap) {
+  ExpectToMatchAnOrderedMap<TimingWheel<Timer>>(1000000, 20000);
+  // mostly beyond the range of the wheel
+  ExpectToMatchAnOrderedMap<TinyWheel>(1000, 200);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
@@ -1,12 +1,22 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
 #include <typeinfo>
 #include <utility>
 
 // for aligned_storage
 #include <type_traits>
 
+#include "try_equals.hpp"
+#include "type_id.hpp"
+
 // template <typename E>
 // constexpr auto ToUType(E enumerator) noexcept {
 //   return static_cast<std::underlying_type_t<E>>(enumerator);
@@ -19,9 +29,347 @@ class BadAnyCast : public std::bad_cast {
   virtual const char* what() const noexcept override { return "bad any_cast"; }
 };
 
-inline void ThrowBadAnyCast() { throw BadAnyCast{}; }
+[[noreturn]] inline void ThrowBadAnyCast() { throw BadAnyCast{}; }
+
+class NotHashable : public std::exception {
+ public:
+  virtual const char* what() const noexcept override {
+    return "std::hash is not enabled for the contained type";
+  }
+};
+
+// Whether a Tp can be moved to another address by copying its bytes, without
+// running its move constructor or its destructor on the source. Any moves
+// and swaps such objects with memcpy. Types that are not trivially copyable
+// but never point into themselves, e.g. most handles and smart pointers, can
+// opt in with
+//
+//   template <>
+//   struct cpp_idioms::IsTriviallyRelocatable<Handle> : std::true_type {};
+//
+// Do not opt in types that hold pointers into themselves, such as
+// std::string with its small buffer in libstdc++.
+template <typename Tp>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Tp> {};
+
+template <typename Tp>
+struct IsTriviallyRelocatable<std::unique_ptr<Tp>> : std::true_type {};
+
+namespace any_internal {
+
+struct VTable;
+
+// The storage a value is copied or moved into. The source picks in-place or
+// heap storage according to |size| and |align|, allocates heap objects from
+// |resource| and reports the table of the new contained object back in
+// |vtable|. A null |resource| stands for the global operator new.
+struct Target {
+  void* storage;
+  std::size_t size;
+  std::size_t align;
+  std::pmr::memory_resource* resource;
+  const VTable* vtable;
+};
+
+// Operations on a contained object of one type. Tables only see the raw
+// storage of an any object, so the same table serves every BasicAny capacity
+// and values can travel between them. |resource| is the memory resource the
+// contained object was allocated from.
+struct VTable {
+  // Destroy the contained object.
+  void (*destroy)(void* storage, std::pmr::memory_resource* resource) noexcept;
+  // Move the contained object into |target|, |storage| is left empty.
+  void (*move)(void* storage, std::pmr::memory_resource* resource,
+               Target* target);
+  // Copy the contained object into |target|, null for move-only types.
+  void (*copy)(const void* storage, Target* target);
+  // The identity of the contained type, which types of the same name share.
+  TypeId type_id;
+  // The identity no other type shares, see kTypeTag.
+  const void* type_tag;
+  // The typeid of the contained object, null without RTTI.
+  const std::type_info& (*type)() noexcept;
+  // The address of the contained object.
+  void* (*access)(const void* storage) noexcept;
+  // Whether the contained object moves with the bytes of the storage to an
+  // any object of the same capacity and memory resource.
+  bool relocatable;
+  // Compare the contained object to |object| of the same type, null if the
+  // type has no operator==.
+  bool (*equals)(const void* storage, const void* object);
+  // Hash the contained object and its type, null if std::hash is disabled
+  // for the type.
+  std::size_t (*hash)(const void* storage);
+};
+
+// Whether two tables manage objects of the same type. Different ids rule out
+// other types with one comparison. Types of the same name, such as two
+// lambdas of one function, share an id and are told apart by their tags, and
+// where the tags of a type are duplicated across shared libraries of hidden
+// visibility, by their typeid if there is RTTI.
+inline bool SameType(const VTable* lhs, const VTable* rhs) noexcept {
+  if (lhs == rhs) return true;
+  if (lhs->type_id != rhs->type_id) return false;
+  if (lhs->type_tag == rhs->type_tag) return true;
+#if CPP_IDIOMS_HAS_RTTI
+  return lhs->type() == rhs->type();
+#else
+  return false;
+#endif
+}
+
+// Whether a Tp is kept in a buffer of |size| bytes aligned to |align|.
+template <typename Tp>
+constexpr bool FitsInternal(std::size_t size, std::size_t align) {
+  return std::is_nothrow_move_constructible_v<Tp> && sizeof(Tp) <= size &&
+         alignof(Tp) <= align;
+}
+
+// Whether memory allocated from |lhs| can be released through |rhs|.
+inline bool SameResource(std::pmr::memory_resource* lhs,
+                         std::pmr::memory_resource* rhs) noexcept {
+  if (lhs == rhs) return true;
+  return lhs && rhs && lhs->is_equal(*rhs);
+}
+
+template <typename Tp, typename... Args>
+void CreateIn(Target* target, Args&&... args);
+
+template <typename Tp>
+constexpr auto TypeInfoOf() noexcept {
+  using TypeInfoFn = const std::type_info& (*)() noexcept;
+#if CPP_IDIOMS_HAS_RTTI
+  return TypeInfoFn{[]() noexcept -> const std::type_info& {
+    return typeid(Tp);
+  }};
+#else
+  return TypeInfoFn{nullptr};
+#endif
+}
+
+// The copy operation of Manager, null if a Tp cannot be copied.
+template <typename Tp, typename Manager>
+constexpr auto CopyOf() noexcept {
+  using CopyFn = void (*)(const void*, Target*);
+  if constexpr (std::is_copy_constructible_v<Tp>) {
+    return CopyFn{[](const void* storage, Target* target) {
+      CreateIn<Tp>(target, static_cast<const Tp&>(*Manager::Access(storage)));
+    }};
+  } else {
+    return CopyFn{nullptr};
+  }
+}
+
+// Whether Tp == Tp compiles. The operator== of standard containers, pairs
+// and tuples accepts any element type, so their elements are looked into.
+template <typename Tp, typename = void>
+struct EqualityComparable
+    : std::bool_constant<IsEqualityComparable<Tp>::value> {};
+
+template <typename Tp>
+struct EqualityComparable<Tp, std::void_t<typename Tp::value_type>>
+    : std::bool_constant<
+          IsEqualityComparable<Tp>::value &&
+          EqualityComparable<std::remove_cv_t<typename Tp::value_type>>::value> {
+};
+
+template <typename T1, typename T2>
+struct EqualityComparable<std::pair<T1, T2>>
+    : std::bool_constant<EqualityComparable<std::remove_cv_t<T1>>::value &&
+                         EqualityComparable<std::remove_cv_t<T2>>::value> {};
+
+template <typename... Ts>
+struct EqualityComparable<std::tuple<Ts...>>
+    : std::conjunction<EqualityComparable<std::remove_cv_t<Ts>>...> {};
+
+template <typename Tp, typename = void>
+struct Hashable : std::false_type {};
+
+template <typename Tp>
+struct Hashable<Tp, std::void_t<decltype(std::hash<Tp>{}(
+                        std::declval<const Tp&>()))>> : std::true_type {};
+
+// The equality operation of Manager, null if a Tp cannot be compared.
+template <typename Tp, typename Manager>
+constexpr auto EqualsOf() noexcept {
+  using EqualsFn = bool (*)(const void*, const void*);
+  if constexpr (EqualityComparable<Tp>::value) {
+    return EqualsFn{[](const void* storage, const void* object) -> bool {
+      return *Manager::Access(storage) == *static_cast<const Tp*>(object);
+    }};
+  } else {
+    return EqualsFn{nullptr};
+  }
+}
+
+// The hash operation of Manager, null if std::hash<Tp> is disabled. Equal
+// values of different types get different hashes.
+template <typename Tp, typename Manager>
+constexpr auto HashOf() noexcept {
+  using HashFn = std::size_t (*)(const void*);
+  if constexpr (Hashable<Tp>::value) {
+    return HashFn{[](const void* storage) -> std::size_t {
+      std::size_t hash = std::hash<Tp>{}(*Manager::Access(storage));
+      return hash ^ (static_cast<std::size_t>(kTypeId<Tp>.Value()) +
+                     0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+    }};
+  } else {
+    return HashFn{nullptr};
+  }
+}
+
+// Manage in-place contained object
+template <typename Tp>
+struct ManagerInternal {
+  template <typename... Args>
+  static void Create(void* storage, std::pmr::memory_resource*,
+                     Args&&... args) {
+    ::new (storage) Tp(std::forward<Args>(args)...);
+  }
+
+  static Tp* Access(const void* storage) noexcept {
+    return static_cast<Tp*>(const_cast<void*>(storage));
+  }
+
+  static void Destroy(void* storage, std::pmr::memory_resource*) noexcept {
+    Access(storage)->~Tp();
+  }
+
+  static void Move(void* storage, std::pmr::memory_resource* resource,
+                   Target* target) {
+    CreateIn<Tp>(target, std::move(*Access(storage)));
+    Destroy(storage, resource);
+  }
+
+  static void* Address(const void* storage) noexcept {
+    return Access(storage);
+  }
+
+  static constexpr VTable kVTable{&Destroy,
+                                  &Move,
+                                  CopyOf<Tp, ManagerInternal>(),
+                                  kTypeId<Tp>,
+                                  kTypeTag<Tp>,
+                                  TypeInfoOf<Tp>(),
+                                  &Address,
+                                  IsTriviallyRelocatable<Tp>::value,
+                                  EqualsOf<Tp, ManagerInternal>(),
+                                  HashOf<Tp, ManagerInternal>()};
+};
+
+// Manage external contained object.
+template <typename Tp>
+struct ManagerExternal {
+  template <typename... Args>
+  static void Create(void* storage, std::pmr::memory_resource* resource,
+                     Args&&... args) {
+    if (!resource) {
+      *static_cast<void**>(storage) = new Tp(std::forward<Args>(args)...);
+      return;
+    }
+    void* ptr = resource->allocate(sizeof(Tp), alignof(Tp));
+    try {
+      ::new (ptr) Tp(std::forward<Args>(args)...);
+    } catch (...) {
+      resource->deallocate(ptr, sizeof(Tp), alignof(Tp));
+      throw;
+    }
+    *static_cast<void**>(storage) = ptr;
+  }
+
+  static Tp* Access(const void* storage) noexcept {
+    return static_cast<Tp*>(*static_cast<void* const*>(storage));
+  }
+
+  static void Destroy(void* storage,
+                      std::pmr::memory_resource* resource) noexcept {
+    Tp* ptr = Access(storage);
+    if (!resource) {
+      delete ptr;
+      return;
+    }
+    ptr->~Tp();
+    resource->deallocate(ptr, sizeof(Tp), alignof(Tp));
+  }
+
+  static void Move(void* storage, std::pmr::memory_resource* resource,
+                   Target* target) {
+    if (FitsInternal<Tp>(target->size, target->align) ||
+        !SameResource(resource, target->resource)) {
+      // a larger destination can take the object out of the heap, another
+      // resource needs a new allocation
+      CreateIn<Tp>(target, std::move(*Access(storage)));
+      Destroy(storage, resource);
+    } else {
+      *static_cast<void**>(target->storage) = Access(storage);
+      target->vtable = &kVTable;
+    }
+  }
+
+  static void* Address(const void* storage) noexcept {
+    return Access(storage);
+  }
+
+  static constexpr VTable kVTable{&Destroy,
+                                  &Move,
+                                  CopyOf<Tp, ManagerExternal>(),
+                                  kTypeId<Tp>,
+                                  kTypeTag<Tp>,
+                                  TypeInfoOf<Tp>(),
+                                  &Address,
+                                  // only the pointer moves
+                                  true,
+                                  EqualsOf<Tp, ManagerExternal>(),
+                                  HashOf<Tp, ManagerExternal>()};
+};
+
+// Create a Tp from args in target, in place if it fits there.
+template <typename Tp, typename... Args>
+void CreateIn(Target* target, Args&&... args) {
+  if (FitsInternal<Tp>(target->size, target->align)) {
+    ManagerInternal<Tp>::Create(target->storage, target->resource,
+                                std::forward<Args>(args)...);
+    target->vtable = &ManagerInternal<Tp>::kVTable;
+  } else {
+    ManagerExternal<Tp>::Create(target->storage, target->resource,
+                                std::forward<Args>(args)...);
+    target->vtable = &ManagerExternal<Tp>::kVTable;
+  }
+}
+
+// Heap objects come from the global operator new. Being an empty base, this
+// adds nothing to the size of the any object.
+class NewDeleteResource {
+ public:
+  static constexpr bool kAlwaysEqual = true;
+
+  std::pmr::memory_resource* Get() const noexcept { return nullptr; }
+};
+
+// Heap objects come from a std::pmr::memory_resource chosen at construction,
+// the default resource unless given. As with std::pmr containers, copies
+// start out on the default resource and moves keep the source's resource.
+class PmrResource {
+ public:
+  static constexpr bool kAlwaysEqual = false;
+
+  PmrResource() noexcept : resource_(std::pmr::get_default_resource()) {}
+  explicit PmrResource(std::pmr::memory_resource* resource) noexcept
+      : resource_(resource) {}
+
+  std::pmr::memory_resource* Get() const noexcept { return resource_; }
+
+ private:
+  std::pmr::memory_resource* resource_;
+};
+
+// The storage, table and memory resource of BasicAny and BasicUniqueAny,
+// which only differ in the types they accept and whether they copy.
+template <std::size_t Size, std::size_t Align, typename Resource>
+class AnyBase : private Resource {
+  static_assert(Size >= sizeof(void*) && Align >= alignof(void*),
+                "storage must be able to hold a pointer to a heap object");
 
-class Any {
   // Holds either pointer to a heap object or the contained object itself.
   union Storage {
     constexpr Storage() : ptr{nullptr} {}
@@ -31,71 +379,267 @@ class Any {
     Storage& operator=(const Storage&) = delete;
 
     void* ptr;
-    std::aligned_storage_t<sizeof(ptr), alignof(void*)> buffer;
+    std::aligned_storage_t<Size, Align> buffer;
   };
 
-  template <typename Tp, bool Fits = (sizeof(Tp) <= sizeof(Storage)) &&
-                                     (alignof(Tp) <= alignof(Storage))>
-  using Internal =
-      std::integral_constant<bool,
-                             std::is_nothrow_move_constructible_v<Tp> && Fits>;
-
-  template <typename Tp>
-  struct ManagerInternal;
-
+ protected:
   template <typename Tp>
-  struct ManagerExternal;
+  using Internal = std::integral_constant<bool, FitsInternal<Tp>(Size, Align)>;
 
   template <typename Tp>
   using Manager = std::conditional_t<Internal<Tp>::value, ManagerInternal<Tp>,
                                      ManagerExternal<Tp>>;
 
-  template <typename Tp, typename Decayed = std::decay_t<Tp>>
-  using Decay = std::enable_if_t<!std::is_same_v<Decayed, Any>, Decayed>;
+  // Only allocator-aware any objects take a memory resource.
+  template <typename R>
+  using AllocatorAware = std::enable_if_t<
+      std::is_constructible_v<R, std::pmr::memory_resource*>, bool>;
 
-  // Emplace with an object created from args as the contained object
-  template <typename Tp, typename... Args, typename Mgr = Manager<Tp>>
-  void DoEmplace(Args&&... args) {
-    Mgr::Create(storage_, std::forward<Args>(args)...);
-    manager_ = &Mgr::Manage;
+  constexpr AnyBase() noexcept : Resource(), vtable_(nullptr) {}
+
+  // Start out empty, allocating from the same resource as |resource|.
+  explicit AnyBase(const Resource& resource) noexcept
+      : Resource(resource), vtable_(nullptr) {}
+
+  AnyBase(const AnyBase&) = delete;
+  AnyBase& operator=(const AnyBase&) = delete;
+
+  ~AnyBase() { Reset(); }
+
+  const Resource& GetResource() const noexcept { return *this; }
+
+  // Create a Tp from args as the contained object of this empty object.
+  template <typename Tp, typename... Args>
+  Tp& Construct(Args&&... args) {
+    Manager<Tp>::Create(&storage_, Resource::Get(),
+                        std::forward<Args>(args)...);
+    vtable_ = &Manager<Tp>::kVTable;
+    return *Manager<Tp>::Access(&storage_);
   }
 
-  // Emplace with an object created from il and args as the contained object.
-  template <typename Tp, typename Up, typename... Args,
-            typename Mgr = Manager<Tp>>
-  void DoEmplace(std::initializer_list<Up> il, Args&&... args) {
+  // Emplace with an object created from args as the contained object
+  template <typename Tp, typename... Args>
+  Tp& DoEmplace(Args&&... args) {
     Reset();
-    Mgr::Create(storage_, il, std::forward<Args>(args)...);
-    manager_ = &Mgr::Manage;
+    return Construct<Tp>(std::forward<Args>(args)...);
   }
 
- public:
-  // construct/destruct
+  // Copy the contained object of other into this empty object.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  void CloneFrom(const AnyBase<OtherSize, OtherAlign, OtherResource>& other) {
+    if (!other.HasValue()) return;
+    Target target{&storage_, Size, Align, Resource::Get(), nullptr};
+    other.vtable_->copy(&other.storage_, &target);
+    vtable_ = target.vtable;
+  }
 
-  // Default constructor, create an empty object.
-  constexpr Any() noexcept : manager_(nullptr) {}
+  // Transfer the contained object of other into this empty object.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  void XferFrom(AnyBase<OtherSize, OtherAlign, OtherResource>& other) {
+    if (!other.HasValue()) return;
+    Target target{&storage_, Size, Align, Resource::Get(), nullptr};
+    other.vtable_->move(&other.storage_, other.GetMemoryResource(), &target);
+    vtable_ = target.vtable;
+    other.vtable_ = nullptr;
+  }
 
-  // Copy constructor, copies the state of other
-  Any(const Any& other) {
-    if (!other.HasValue()) {
-      manager_ = nullptr;
-    } else {
-      Arg arg;
-      arg.any_ptr = this;
-      other.manager_(Operator::kClone, &other, &arg);
+  // Whether the state of this object can be moved to other, an object of the
+  // same capacity, by copying the storage.
+  bool CanRelocateTo(const AnyBase& other) const noexcept {
+    if (HasValue() && !vtable_->relocatable) return false;
+    return Resource::kAlwaysEqual ||
+           SameResource(Resource::Get(), other.GetMemoryResource());
+  }
+
+  // Transfer the contained object of other, an object of the same capacity,
+  // into this empty object.
+  void RelocateFrom(AnyBase& other) {
+    if (!other.HasValue()) return;
+    if (!other.CanRelocateTo(*this)) {
+      XferFrom(other);
+      return;
     }
+    std::memcpy(&storage_.buffer, &other.storage_.buffer, sizeof(Storage));
+    vtable_ = other.vtable_;
+    other.vtable_ = nullptr;
   }
-  // Move constructor, transfer the state from other
-  Any(Any&& other) {
-    if (!other.HasValue()) {
-      manager_ = nullptr;
+
+  // Exchange state with another object, memory resources stay in place.
+  void SwapWith(AnyBase& rhs) {
+    if (!HasValue() && !rhs.HasValue()) return;
+    if (CanRelocateTo(rhs) && rhs.CanRelocateTo(*this)) {
+      std::aligned_storage_t<Size, Align> temp;
+      std::memcpy(&temp, &storage_.buffer, sizeof(Storage));
+      std::memcpy(&storage_.buffer, &rhs.storage_.buffer, sizeof(Storage));
+      std::memcpy(&rhs.storage_.buffer, &temp, sizeof(Storage));
+      std::swap(vtable_, rhs.vtable_);
+      return;
+    }
+    if (HasValue() && rhs.HasValue()) {
+      if (this == &rhs) return;
+      AnyBase temp(rhs.GetResource());
+      temp.XferFrom(rhs);
+      rhs.XferFrom(*this);
+      XferFrom(temp);
     } else {
-      Arg arg;
-      arg.any_ptr = this;
-      other.manager_(Operator::kXfer, &other, &arg);
+      AnyBase* empty = !HasValue() ? this : &rhs;
+      AnyBase* full = !HasValue() ? &rhs : this;
+      empty->XferFrom(*full);
+    }
+  }
+
+ public:
+  // modifiers
+  void Reset() noexcept {
+    if (HasValue()) {
+      vtable_->destroy(&storage_, Resource::Get());
+      vtable_ = nullptr;
     }
   }
 
+  // observers
+  bool HasValue() const noexcept { return vtable_ != nullptr; }
+
+  // The identity of the contained type, or TypeId() if empty
+  TypeId GetTypeId() const noexcept {
+    return HasValue() ? vtable_->type_id : TypeId();
+  }
+
+#if CPP_IDIOMS_HAS_RTTI
+  // The typeid of the contained object, or typeid(void) if empty
+  const std::type_info& Type() const noexcept {
+    if (!HasValue()) return typeid(void);
+    return vtable_->type();
+  }
+#endif
+
+  // The resource heap objects are allocated from, nullptr if they come from
+  // the global operator new.
+  std::pmr::memory_resource* GetMemoryResource() const noexcept {
+    return Resource::Get();
+  }
+
+  // Whether other holds an equal object of the same type, or both are empty.
+  // Throws NotEqualityComparable if the contained type has no operator==.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  bool Equals(
+      const AnyBase<OtherSize, OtherAlign, OtherResource>& other) const {
+    if (!HasValue() || !other.HasValue()) {
+      return HasValue() == other.HasValue();
+    }
+    if (!SameType(vtable_, other.vtable_)) return false;
+    if (!vtable_->equals) throw NotEqualityComparable();
+    return vtable_->equals(&storage_, other.vtable_->access(&other.storage_));
+  }
+
+  // A hash of the contained object and its type, 0 if empty. Throws
+  // NotHashable if std::hash is not enabled for the contained type.
+  std::size_t Hash() const {
+    if (!HasValue()) return 0;
+    if (!vtable_->hash) throw NotHashable();
+    return vtable_->hash(&storage_);
+  }
+
+  // Whether a Tp would be kept in place rather than on the heap.
+  template <typename Tp>
+  static constexpr bool IsStoredInline() noexcept {
+    return Internal<std::decay_t<Tp>>::value;
+  }
+
+ private:
+  const VTable* vtable_;
+  Storage storage_;
+
+  template <std::size_t, std::size_t, typename>
+  friend class AnyBase;
+
+  template <typename Tp, std::size_t S, std::size_t A, typename R>
+  friend void* AnyCaster(const AnyBase<S, A, R>* any);
+};
+
+template <typename Tp, std::size_t Size, std::size_t Align, typename Resource>
+void* AnyCaster(const AnyBase<Size, Align, Resource>* any) {
+  using Up = std::remove_cv_t<Tp>;
+  using Manager = typename AnyBase<Size, Align, Resource>::template Manager<Up>;
+  if constexpr (!std::is_same_v<std::decay_t<Up>, Up>)
+    return nullptr;
+  else if (any->vtable_ == &Manager::kVTable)
+    return Manager::Access(&any->storage_);
+  else if (any->HasValue() &&
+           SameType(any->vtable_, &Manager::kVTable))
+    // tables of one type may be duplicated across shared libraries
+    return any->vtable_->access(&any->storage_);
+  return nullptr;
+}
+
+}  // namespace any_internal
+
+// An Any whose contained object is kept in place when it is nothrow movable
+// and fits in Size bytes aligned to Align, and otherwise on the heap obtained
+// through Resource.
+template <std::size_t Size, std::size_t Align,
+          typename Resource = any_internal::NewDeleteResource>
+class BasicAny;
+
+// A move-only BasicAny whose contained object need not be copyable.
+template <std::size_t Size, std::size_t Align,
+          typename Resource = any_internal::NewDeleteResource>
+class BasicUniqueAny;
+
+template <typename Tp>
+struct IsBasicAny : std::false_type {};
+
+template <std::size_t Size, std::size_t Align, typename Resource>
+struct IsBasicAny<BasicAny<Size, Align, Resource>> : std::true_type {};
+
+template <std::size_t Size, std::size_t Align, typename Resource>
+struct IsBasicAny<BasicUniqueAny<Size, Align, Resource>> : std::true_type {};
+
+template <std::size_t Size, std::size_t Align, typename Resource>
+class BasicAny : public any_internal::AnyBase<Size, Align, Resource> {
+  using Base = any_internal::AnyBase<Size, Align, Resource>;
+
+  template <typename Tp, typename Decayed = std::decay_t<Tp>>
+  using Decay = std::enable_if_t<!IsBasicAny<Decayed>::value, Decayed>;
+
+  template <typename R>
+  using AllocatorAware = typename Base::template AllocatorAware<R>;
+
+  // Start out empty, allocating from the same resource as |resource|.
+  explicit BasicAny(const Resource& resource) noexcept : Base(resource) {}
+
+ public:
+  // construct/destruct
+
+  // Default constructor, create an empty object.
+  constexpr BasicAny() noexcept = default;
+
+  // Copy constructor, copies the state of other onto the default resource
+  BasicAny(const BasicAny& other) : Base() { this->CloneFrom(other); }
+
+  // Move constructor, transfer the state and memory resource from other
+  BasicAny(BasicAny&& other) noexcept : Base(other.GetResource()) {
+    this->RelocateFrom(other);
+  }
+
+  // Copy the state of an any object with a different capacity
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicAny(const BasicAny<OtherSize, OtherAlign, OtherResource>& other) {
+    this->CloneFrom(other);
+  }
+
+  // Transfer the state from an any object with a different capacity, this
+  // allocates when the contained object no longer fits in place.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicAny(BasicAny<OtherSize, OtherAlign, OtherResource>&& other) {
+    this->XferFrom(other);
+  }
+
   template <typename Res, typename Tp, typename... Args>
   using any_constructible =
       std::enable_if<std::conjunction_v<std::is_copy_constructible<Tp>,
@@ -108,140 +652,166 @@ class Any {
 
   // Construct with a copy of value as the contained object
   template <typename ValueType, typename Tp = Decay<ValueType>,
-            typename Mgr = Manager<Tp>,
             any_constructible_t<Tp, ValueType&&> = true,
             std::enable_if_t<!std::__is_in_place_type<Tp>::value, bool> = true>
-  Any(ValueType&& value) : manager_(&Mgr::Manage) {
-    Mgr::Create(storage_, std::forward<ValueType>(value));
+  BasicAny(ValueType&& value) {
+    this->template Construct<Tp>(std::forward<ValueType>(value));
   }
 
   // Construct with a copy of value as the contained object
   template <typename ValueType, typename Tp = Decay<ValueType>,
-            typename Mgr = Manager<Tp>,
             std::enable_if_t<
                 std::conjunction_v<
                     std::is_copy_constructible<Tp>,
                     std::negation<std::is_constructible<Tp, ValueType&&>>,
                     std::negation<std::__is_in_place_type<Tp>>>,
                 bool> = false>
-  Any(ValueType&& value) : manager_(&Mgr::Manage) {
-    Mgr::Create(storage_, value);
+  BasicAny(ValueType&& value) {
+    this->template Construct<Tp>(value);
   }
 
   /// Construct with an object created from @p Args as the contained object.
   template <typename ValueType, typename... Args,
-            typename Tp = Decay<ValueType>, typename Mgr = Manager<Tp>,
+            typename Tp = Decay<ValueType>,
             any_constructible_t<Tp, Args&&...> = false>
-  explicit Any(std::in_place_type_t<ValueType>, Args&&... args)
-      : manager_(&Mgr::Manage) {
-    Mgr::Create(storage_, std::forward<Args>(args)...);
+  explicit BasicAny(std::in_place_type_t<ValueType>, Args&&... args) {
+    this->template Construct<Tp>(std::forward<Args>(args)...);
   }
 
   /// Construct with an object created from @p il and @p Args as
   /// the contained object.
   template <
       typename ValueType, typename Up, typename... Args,
-      typename Tp = Decay<ValueType>, typename Mgr = Manager<Tp>,
+      typename Tp = Decay<ValueType>,
       any_constructible_t<Tp, std::initializer_list<Up>, Args&&...> = false>
-  explicit Any(std::in_place_type_t<ValueType>, std::initializer_list<Up> il,
-               Args&&... args)
-      : manager_(&Mgr::Manage) {
-    Mgr::Create(storage_, il, std::forward<Args>(args)...);
+  explicit BasicAny(std::in_place_type_t<ValueType>,
+                    std::initializer_list<Up> il, Args&&... args) {
+    this->template Construct<Tp>(il, std::forward<Args>(args)...);
   }
 
-  // Destructor
-  ~Any() { Reset(); }
+  // allocator-extended constructors, heap objects come from |resource|
+
+  // Create an empty object.
+  template <typename R = Resource, AllocatorAware<R> = true>
+  BasicAny(std::allocator_arg_t, std::pmr::memory_resource* resource) noexcept
+      : Base(Resource(resource)) {}
+
+  // Copy the state of another any object.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource, typename R = Resource,
+            AllocatorAware<R> = true>
+  BasicAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+           const BasicAny<OtherSize, OtherAlign, OtherResource>& other)
+      : Base(Resource(resource)) {
+    this->CloneFrom(other);
+  }
+
+  // Transfer the state from another any object.
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource, typename R = Resource,
+            AllocatorAware<R> = true>
+  BasicAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+           BasicAny<OtherSize, OtherAlign, OtherResource>&& other)
+      : Base(Resource(resource)) {
+    this->XferFrom(other);
+  }
+
+  // Construct with a copy of value as the contained object
+  template <typename ValueType, typename Tp = Decay<ValueType>,
+            any_constructible_t<Tp, ValueType&&> = true,
+            std::enable_if_t<!std::__is_in_place_type<Tp>::value, bool> = true,
+            typename R = Resource, AllocatorAware<R> = true>
+  BasicAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+           ValueType&& value)
+      : Base(Resource(resource)) {
+    this->template Construct<Tp>(std::forward<ValueType>(value));
+  }
+
+  /// Construct with an object created from @p Args as the contained object.
+  template <typename ValueType, typename... Args,
+            typename Tp = Decay<ValueType>,
+            any_constructible_t<Tp, Args&&...> = false, typename R = Resource,
+            AllocatorAware<R> = true>
+  BasicAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+           std::in_place_type_t<ValueType>, Args&&... args)
+      : Base(Resource(resource)) {
+    this->template Construct<Tp>(std::forward<Args>(args)...);
+  }
 
   // assignments
 
-  // Copy the state of another object
-  Any& operator=(const Any& rhs) {
-    *this = Any(rhs);
+  // Copy the state of another object, the memory resource is kept
+  BasicAny& operator=(const BasicAny& rhs) {
+    BasicAny temp(this->GetResource());
+    temp.CloneFrom(rhs);
+    *this = std::move(temp);
     return *this;
   }
 
-  // Move assignment operator
-  Any& operator=(Any&& rhs) noexcept {
-    if (!rhs.HasValue()) {
-      Reset();
-    } else if (this != &rhs) {
-      Reset();
-      Arg arg;
-      arg.any_ptr = this;
-      rhs.manager_(Operator::kXfer, &rhs, &arg);
+  // Move assignment operator. The memory resource is kept, an object from
+  // another resource is moved into a new allocation.
+  BasicAny& operator=(BasicAny&& rhs) noexcept(Resource::kAlwaysEqual) {
+    if (this != &rhs) {
+      this->Reset();
+      this->RelocateFrom(rhs);
     }
     return *this;
   }
 
+  // Copy the state of an any object with a different capacity
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicAny& operator=(
+      const BasicAny<OtherSize, OtherAlign, OtherResource>& rhs) {
+    BasicAny temp(this->GetResource());
+    temp.CloneFrom(rhs);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  // Transfer the state from an any object with a different capacity
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicAny& operator=(BasicAny<OtherSize, OtherAlign, OtherResource>&& rhs) {
+    this->Reset();
+    this->XferFrom(rhs);
+    return *this;
+  }
+
   // Store a copy of rhs as the contained object
   template <typename ValueType>
-  std::enable_if_t<std::is_copy_constructible_v<Decay<ValueType>>, Any&>
+  std::enable_if_t<std::is_copy_constructible_v<Decay<ValueType>>, BasicAny&>
   operator=(ValueType&& rhs) {
-    *this = Any(std::forward<ValueType>(rhs));
+    BasicAny temp(this->GetResource());
+    temp.template Construct<Decay<ValueType>>(std::forward<ValueType>(rhs));
+    *this = std::move(temp);
     return *this;
   }
 
   /// Emplace with an object created from @p Args as the contained object.
   template <typename ValueType, typename... Args>
-  any_constructible_t<Decay<ValueType>&, Decay<ValueType>, Args&&...> emplace(
-      Args&&... args) {
-    DoEmplace<Decay<ValueType>>(std::forward<Args>(args)...);
-    Any::Arg arg;
-    this->manager_(Any::Operator::kAccess, this, &arg);
-    return *static_cast<Decay<ValueType>*>(arg.obj);
+  typename any_constructible<Decay<ValueType>&, Decay<ValueType>,
+                            Args&&...>::type
+  emplace(Args&&... args) {
+    return this->template DoEmplace<Decay<ValueType>>(
+        std::forward<Args>(args)...);
   }
 
   /// Emplace with an object created from @p il and @p Args as
   /// the contained object.
   template <typename ValueType, typename Up, typename... Args>
-  any_constructible_t<Decay<ValueType>&, Decay<ValueType>,
-                      std::initializer_list<Up>, Args&&...>
+  typename any_constructible<Decay<ValueType>&, Decay<ValueType>,
+                            std::initializer_list<Up>, Args&&...>::type
   Emplace(std::initializer_list<Up> il, Args&&... args) {
-    DoEmplace<Decay<ValueType>, Up>(il, std::forward<Args>(args)...);
-    Any::Arg arg;
-    this->manager_(Any::Operator::kAccess, this, &arg);
-    return *static_cast<Decay<ValueType>*>(arg.obj);
+    return this->template DoEmplace<Decay<ValueType>>(
+        il, std::forward<Args>(args)...);
   }
 
   // modifiers
-  void Reset() noexcept {
-    if (HasValue()) {
-      manager_(Operator::kDestroy, this, nullptr);
-      manager_ = nullptr;
-    }
-  }
-  // Exchange state with another object
-  void Swap(Any& rhs) noexcept {
-    if (!HasValue() && !rhs.HasValue()) return;
-    if (HasValue() && rhs.HasValue()) {
-      if (this == &rhs) return;
-      Any temp;
-      Arg arg;
-      arg.any_ptr = &temp;
-      rhs.manager_(Operator::kXfer, &rhs, &arg);
-      arg.any_ptr = &rhs;
-      manager_(Operator::kXfer, this, &arg);
-      arg.any_ptr = this;
-      temp.manager_(Operator::kXfer, &temp, &arg);
 
-    } else {
-      Any* empty = !HasValue() ? this : &rhs;
-      Any* full = !HasValue() ? &rhs : this;
-      Arg arg;
-      arg.any_ptr = empty;
-      full->manager_(Operator::kXfer, full, &arg);
-    }
-  }
-
-  // observers
-  bool HasValue() const noexcept { return manager_ != nullptr; }
-
-  // The typeid of the contained object, or typeid(void) if empty
-  const std::type_info& Type() const noexcept {
-    if (!HasValue()) return typeid(void);
-    Arg arg;
-    manager_(Operator::KGetTypeInfo, this, &arg);
-    return *arg.typeinfo_ptr;
+  // Exchange state with another object, memory resources stay in place.
+  void Swap(BasicAny& rhs) noexcept(Resource::kAlwaysEqual) {
+    this->SwapWith(rhs);
   }
 
   template <typename Tp>
@@ -249,56 +819,204 @@ class Any {
     return std::disjunction_v<std::is_reference<Tp>,
                               std::is_copy_constructible<Tp>>;
   }
+};
 
- private:
-  enum class Operator { kAccess, KGetTypeInfo, kClone, kDestroy, kXfer };
-  union Arg {
-    void* obj;
-    const std::type_info* typeinfo_ptr;
-    Any* any_ptr;
-  };
+// Holds objects that can be moved but not copied, such as a std::unique_ptr
+// or a std::thread, which BasicAny rejects. In turn a BasicUniqueAny cannot
+// be copied. It takes over the state of a BasicAny by copy or move, so values
+// can be handed from copyable to move-only code but not back.
+template <std::size_t Size, std::size_t Align, typename Resource>
+class BasicUniqueAny : public any_internal::AnyBase<Size, Align, Resource> {
+  using Base = any_internal::AnyBase<Size, Align, Resource>;
 
-  void (*manager_)(Operator, const Any*, Arg*);
-  Storage storage_;
+  template <typename Tp, typename Decayed = std::decay_t<Tp>>
+  using Decay = std::enable_if_t<!IsBasicAny<Decayed>::value, Decayed>;
 
-  template <typename Tp>
-  friend void* AnyCaster(const Any* any);
+  template <typename R>
+  using AllocatorAware = typename Base::template AllocatorAware<R>;
 
-  // Manage in-place contained object
-  template <typename Tp>
-  struct ManagerInternal {
-    static void Manage(Operator which, const Any* any_ptr, Arg* arg);
-    template <typename Up>
-    static void Create(Storage& storage, Up&& value) {
-      void* addr = &storage.buffer;
-      ::new (addr) Tp(std::forward<Up>(value));
-    }
+  template <typename Tp, typename... Args>
+  using unique_any_constructible_t = std::enable_if_t<
+      std::conjunction_v<std::is_move_constructible<Tp>,
+                         std::is_constructible<Tp, Args...>>,
+      bool>;
 
-    template <typename... Args>
-    static void Create(Storage& storage, Args&&... args) {
-      void* addr = &storage.buffer;
-      ::new (addr) Tp(std::forward<Arg>(args)...);
-    }
-  };
+ public:
+  // construct/destruct
 
-  // Manage external contained object.
-  template <typename Tp>
-  struct ManagerExternal {
-    static void Manage(Operator which, const Any* any_ptr, Arg* arg);
-    template <typename Up>
-    static void Create(Storage& storage, Up&& value) {
-      storage.ptr = new Tp(std::forward<Up>(value));
-    }
+  // Default constructor, create an empty object.
+  constexpr BasicUniqueAny() noexcept = default;
+
+  BasicUniqueAny(const BasicUniqueAny&) = delete;
+
+  // Move constructor, transfer the state and memory resource from other
+  BasicUniqueAny(BasicUniqueAny&& other) noexcept : Base(other.GetResource()) {
+    this->RelocateFrom(other);
+  }
+
+  // Transfer the state from a unique any object with a different capacity
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicUniqueAny(BasicUniqueAny<OtherSize, OtherAlign, OtherResource>&& other) {
+    this->XferFrom(other);
+  }
+
+  // Copy the state of a copyable any object
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicUniqueAny(const BasicAny<OtherSize, OtherAlign, OtherResource>& other) {
+    this->CloneFrom(other);
+  }
+
+  // Transfer the state from a copyable any object
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicUniqueAny(BasicAny<OtherSize, OtherAlign, OtherResource>&& other) {
+    this->XferFrom(other);
+  }
+
+  // Construct with value as the contained object
+  template <typename ValueType, typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, ValueType&&> = true,
+            std::enable_if_t<!std::__is_in_place_type<Tp>::value, bool> = true>
+  BasicUniqueAny(ValueType&& value) {
+    this->template Construct<Tp>(std::forward<ValueType>(value));
+  }
 
-    template <typename... Args>
-    static void Create(Storage& storage, Args&&... args) {
-      storage.ptr = new Tp(std::forward<Args>(args)...);
+  /// Construct with an object created from @p Args as the contained object.
+  template <typename ValueType, typename... Args,
+            typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, Args&&...> = true>
+  explicit BasicUniqueAny(std::in_place_type_t<ValueType>, Args&&... args) {
+    this->template Construct<Tp>(std::forward<Args>(args)...);
+  }
+
+  // allocator-extended constructors, heap objects come from |resource|
+
+  // Create an empty object.
+  template <typename R = Resource, AllocatorAware<R> = true>
+  BasicUniqueAny(std::allocator_arg_t,
+                 std::pmr::memory_resource* resource) noexcept
+      : Base(Resource(resource)) {}
+
+  // Construct with value as the contained object
+  template <typename ValueType, typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, ValueType&&> = true,
+            std::enable_if_t<!std::__is_in_place_type<Tp>::value, bool> = true,
+            typename R = Resource, AllocatorAware<R> = true>
+  BasicUniqueAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+                 ValueType&& value)
+      : Base(Resource(resource)) {
+    this->template Construct<Tp>(std::forward<ValueType>(value));
+  }
+
+  /// Construct with an object created from @p Args as the contained object.
+  template <typename ValueType, typename... Args,
+            typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, Args&&...> = true,
+            typename R = Resource, AllocatorAware<R> = true>
+  BasicUniqueAny(std::allocator_arg_t, std::pmr::memory_resource* resource,
+                 std::in_place_type_t<ValueType>, Args&&... args)
+      : Base(Resource(resource)) {
+    this->template Construct<Tp>(std::forward<Args>(args)...);
+  }
+
+  // assignments
+
+  BasicUniqueAny& operator=(const BasicUniqueAny&) = delete;
+
+  // Move assignment operator. The memory resource is kept, an object from
+  // another resource is moved into a new allocation.
+  BasicUniqueAny& operator=(BasicUniqueAny&& rhs) noexcept(
+      Resource::kAlwaysEqual) {
+    if (this != &rhs) {
+      this->Reset();
+      this->RelocateFrom(rhs);
     }
-  };
+    return *this;
+  }
+
+  // Transfer the state from a unique any object with a different capacity
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicUniqueAny& operator=(
+      BasicUniqueAny<OtherSize, OtherAlign, OtherResource>&& rhs) {
+    this->Reset();
+    this->XferFrom(rhs);
+    return *this;
+  }
+
+  // Transfer the state from a copyable any object
+  template <std::size_t OtherSize, std::size_t OtherAlign,
+            typename OtherResource>
+  BasicUniqueAny& operator=(
+      BasicAny<OtherSize, OtherAlign, OtherResource>&& rhs) {
+    this->Reset();
+    this->XferFrom(rhs);
+    return *this;
+  }
+
+  // Store rhs as the contained object
+  template <typename ValueType, typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, ValueType&&> = true>
+  BasicUniqueAny& operator=(ValueType&& rhs) {
+    this->template DoEmplace<Tp>(std::forward<ValueType>(rhs));
+    return *this;
+  }
+
+  /// Emplace with an object created from @p Args as the contained object.
+  template <typename ValueType, typename... Args,
+            typename Tp = Decay<ValueType>,
+            unique_any_constructible_t<Tp, Args&&...> = true>
+  Tp& emplace(Args&&... args) {
+    return this->template DoEmplace<Tp>(std::forward<Args>(args)...);
+  }
+
+  // modifiers
+
+  // Exchange state with another object, memory resources stay in place.
+  void Swap(BasicUniqueAny& rhs) noexcept(Resource::kAlwaysEqual) {
+    this->SwapWith(rhs);
+  }
 };
 
+// The in-place buffer of Any holds a single pointer, larger objects go to the
+// heap. Use BasicAny directly to pick a larger capacity for a use site.
+using Any = BasicAny<sizeof(void*), alignof(void*)>;
+
+using UniqueAny = BasicUniqueAny<sizeof(void*), alignof(void*)>;
+
+namespace pmr {
+
+// Any objects whose heap objects come from a std::pmr::memory_resource, e.g.
+// a per-request std::pmr::monotonic_buffer_resource.
+template <std::size_t Size, std::size_t Align>
+using BasicAny = cpp_idioms::BasicAny<Size, Align, any_internal::PmrResource>;
+
+template <std::size_t Size, std::size_t Align>
+using BasicUniqueAny =
+    cpp_idioms::BasicUniqueAny<Size, Align, any_internal::PmrResource>;
+
+using Any = BasicAny<sizeof(void*), alignof(void*)>;
+
+using UniqueAny = BasicUniqueAny<sizeof(void*), alignof(void*)>;
+
+}  // namespace pmr
+
 // Exchange the states of two any objects
-inline void Swap(Any& x, Any& y) noexcept { x.Swap(y); }
+template <std::size_t Size, std::size_t Align, typename Resource>
+inline void Swap(BasicAny<Size, Align, Resource>& x,
+                 BasicAny<Size, Align, Resource>& y) noexcept(noexcept(
+    x.Swap(y))) {
+  x.Swap(y);
+}
+
+template <std::size_t Size, std::size_t Align, typename Resource>
+inline void Swap(BasicUniqueAny<Size, Align, Resource>& x,
+                 BasicUniqueAny<Size, Align, Resource>& y) noexcept(noexcept(
+    x.Swap(y))) {
+  x.Swap(y);
+}
 
 // Create an any holding a Tp constructed form args
 template <typename Tp, typename... Args>
@@ -312,33 +1030,42 @@ Any MakeAny(std::initializer_list<Up> il, Args&&... args) {
   return Any(std::in_place_type<Tp>, il, std::forward<Args>(args)...);
 }
 
+// Create a unique any holding a Tp constructed form args
+template <typename Tp, typename... Args>
+UniqueAny MakeUniqueAny(Args&&... args) {
+  return UniqueAny(std::in_place_type<Tp>, std::forward<Args>(args)...);
+}
+
 template <typename Tp>
 using _AnyCast = std::remove_cv_t<std::remove_reference_t<Tp>>;
 
-template <typename ValueType>
-inline ValueType AnyCast(const Any& any) {
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType AnyCast(const BasicAny<Size, Align, Resource>& any) {
   static_assert(
-      Any::IsValidCast<ValueType>(),
+      BasicAny<Size, Align, Resource>::template IsValidCast<ValueType>(),
       "Template argument must be a reference or CopyConstructible type");
   auto p = AnyCast<_AnyCast<ValueType>>(&any);
   if (p) return static_cast<ValueType>(*p);
   ThrowBadAnyCast();
 }
 
-template <typename ValueType>
-inline ValueType AnyCast(Any& any) {
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType AnyCast(BasicAny<Size, Align, Resource>& any) {
   static_assert(
-      Any::IsValidCast<ValueType>(),
+      BasicAny<Size, Align, Resource>::template IsValidCast<ValueType>(),
       "Template argument must be a reference or CopyConstructible type");
   auto p = AnyCast<_AnyCast<ValueType>>(&any);
   if (p) return static_cast<ValueType>(*p);
   ThrowBadAnyCast();
 }
 
-template <typename ValueType>
-inline ValueType AnyCast(Any&& any) {
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType AnyCast(BasicAny<Size, Align, Resource>&& any) {
   static_assert(
-      Any::IsValidCast<ValueType>(),
+      BasicAny<Size, Align, Resource>::template IsValidCast<ValueType>(),
       "Template argument must be a reference or CopyConstructible type");
   auto p = AnyCast<_AnyCast<ValueType>>(&any);
   if constexpr (!std::is_move_constructible_v<ValueType> ||
@@ -350,96 +1077,96 @@ inline ValueType AnyCast(Any&& any) {
   ThrowBadAnyCast();
 }
 
-template <typename Tp>
-void* AnyCaster(const Any* any) {
-  using Up = std::remove_cv_t<Tp>;
-  if constexpr (!std::is_same_v<std::decay_t<Up>, Up>)
-    return nullptr;
-  else if constexpr (!std::is_copy_constructible_v<Up>)
-    return nullptr;
-  else if (any->manager_ == &Any::Manager<Up>::Manage ||
-           any->Type() == typeid(Tp)) {
-    Any::Arg arg;
-    any->manager_(Any::Operator::kAccess, any, &arg);
-    return arg.obj;
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline const ValueType* AnyCast(
+    const BasicAny<Size, Align, Resource>* any) noexcept {
+  if constexpr (std::is_object_v<ValueType>) {
+    if (any) {
+      return static_cast<ValueType*>(any_internal::AnyCaster<ValueType>(any));
+    }
   }
   return nullptr;
 }
 
-template <typename ValueType>
-inline const ValueType* AnyCast(const Any* any) noexcept {
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType* AnyCast(BasicAny<Size, Align, Resource>* any) noexcept {
   if constexpr (std::is_object_v<ValueType>) {
     if (any) {
-      return static_cast<ValueType*>(AnyCaster<ValueType>(any));
+      return static_cast<ValueType*>(any_internal::AnyCaster<ValueType>(any));
     }
   }
   return nullptr;
 }
 
-template <typename ValueType>
-inline const ValueType* AnyCast(Any* any) noexcept {
+// Casts of a unique any. Casting to a value type copies out of an lvalue and
+// moves out of an rvalue, so a move-only object is either borrowed by
+// reference or taken with UniqueAnyCast<Tp>(std::move(any)).
+
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline const ValueType* UniqueAnyCast(
+    const BasicUniqueAny<Size, Align, Resource>* any) noexcept {
   if constexpr (std::is_object_v<ValueType>) {
     if (any) {
-      return static_cast<ValueType*>(AnyCaster<ValueType>(any));
+      return static_cast<ValueType*>(any_internal::AnyCaster<ValueType>(any));
     }
   }
   return nullptr;
 }
 
-template <typename Tp>
-void Any::ManagerInternal<Tp>::Manage(Operator which, const Any* any,
-                                      Arg* arg) {
-  // the contained object is in storage_.buffer
-  auto ptr = reinterpret_cast<const Tp*>(&any->storage_.buffer);
-  switch (which) {
-    case Operator::kAccess:
-      arg->obj = const_cast<Tp*>(ptr);
-      break;
-    case Operator::KGetTypeInfo:
-      arg->typeinfo_ptr = &typeid(Tp);
-      break;
-    case Operator::kClone:
-      ::new (&arg->any_ptr->storage_.buffer) Tp(*ptr);
-      arg->any_ptr->manager_ = any->manager_;
-      break;
-    case Operator::kDestroy:
-      ptr->~Tp();
-      break;
-    case Operator::kXfer:
-      ::new (&arg->any_ptr->storage_.buffer)
-          Tp(std::move(*const_cast<Tp*>(ptr)));
-      ptr->~Tp();
-      arg->any_ptr->manager_ = any->manager_;
-      const_cast<Any*>(any)->manager_ = nullptr;
-      break;
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType* UniqueAnyCast(
+    BasicUniqueAny<Size, Align, Resource>* any) noexcept {
+  if constexpr (std::is_object_v<ValueType>) {
+    if (any) {
+      return static_cast<ValueType*>(any_internal::AnyCaster<ValueType>(any));
+    }
   }
+  return nullptr;
 }
 
-template <typename Tp>
-void Any::ManagerExternal<Tp>::Manage(Operator which, const Any* any,
-                                      Arg* arg) {
-  // the contained object is in storage_.ptr
-  auto ptr = static_cast<const Tp*>(any->storage_.ptr);
-  switch (which) {
-    case Operator::kAccess:
-      arg->obj = const_cast<Tp*>(ptr);
-      break;
-    case Operator::KGetTypeInfo:
-      arg->typeinfo_ptr = &typeid(Tp);
-      break;
-    case Operator::kClone:
-      arg->any_ptr->storage_.ptr = new Tp(*ptr);
-      arg->any_ptr->manager_ = any->manager_;
-      break;
-    case Operator::kDestroy:
-      delete ptr;
-      break;
-    case Operator::kXfer:
-      arg->any_ptr->storage_.ptr = any->storage_.ptr;
-      arg->any_ptr->manager_ = any->manager_;
-      const_cast<Any*>(any)->manager_ = nullptr;
-      break;
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType UniqueAnyCast(
+    const BasicUniqueAny<Size, Align, Resource>& any) {
+  static_assert(std::disjunction_v<std::is_reference<ValueType>,
+                                   std::is_copy_constructible<ValueType>>,
+                "Template argument must be a reference or CopyConstructible "
+                "type, move the unique any to take a move-only object");
+  auto p = UniqueAnyCast<_AnyCast<ValueType>>(&any);
+  if (p) return static_cast<ValueType>(*p);
+  ThrowBadAnyCast();
+}
+
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType UniqueAnyCast(BasicUniqueAny<Size, Align, Resource>& any) {
+  static_assert(std::disjunction_v<std::is_reference<ValueType>,
+                                   std::is_copy_constructible<ValueType>>,
+                "Template argument must be a reference or CopyConstructible "
+                "type, move the unique any to take a move-only object");
+  auto p = UniqueAnyCast<_AnyCast<ValueType>>(&any);
+  if (p) return static_cast<ValueType>(*p);
+  ThrowBadAnyCast();
+}
+
+template <typename ValueType, std::size_t Size, std::size_t Align,
+          typename Resource>
+inline ValueType UniqueAnyCast(BasicUniqueAny<Size, Align, Resource>&& any) {
+  static_assert(std::disjunction_v<std::is_reference<ValueType>,
+                                   std::is_move_constructible<ValueType>>,
+                "Template argument must be a reference or MoveConstructible "
+                "type");
+  auto p = UniqueAnyCast<_AnyCast<ValueType>>(&any);
+  if constexpr (std::is_lvalue_reference_v<ValueType>) {
+    if (p) return static_cast<ValueType>(*p);
+  } else {
+    if (p) return static_cast<ValueType>(std::move(*p));
   }
+  ThrowBadAnyCast();
 }
 
-}  // namespace cpp_idioms
\ No newline at end of file
+}  // namespace cpp_idioms
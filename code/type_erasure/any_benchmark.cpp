@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "any.hpp"
+
+namespace {
+
+using cpp_idioms::Any;
+using cpp_idioms::AnyCast;
+using cpp_idioms::BasicAny;
+
+using Any32 = BasicAny<32, alignof(std::max_align_t)>;
+
+struct Vec2 {
+  double x;
+  double y;
+
+  bool operator<(const Vec2& rhs) const { return x < rhs.x; }
+};
+
+// Values to fill the vectors with, the same for every run.
+template <typename Tp>
+Tp MakeValue(std::mt19937& rng) {
+  if constexpr (std::is_same_v<Tp, int>) {
+    return static_cast<int>(rng());
+  } else if constexpr (std::is_same_v<Tp, Vec2>) {
+    return Vec2{static_cast<double>(rng()), 0.0};
+  } else {
+    return std::to_string(rng());
+  }
+}
+
+template <typename AnyType, typename Tp>
+std::vector<AnyType> MakeVector(std::size_t size) {
+  std::mt19937 rng(42);
+  std::vector<AnyType> v;
+  v.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) v.emplace_back(MakeValue<Tp>(rng));
+  return v;
+}
+
+void BM_AnyHasValue(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(a.HasValue());
+  }
+}
+BENCHMARK(BM_AnyHasValue);
+
+void BM_AnyType(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(&a.Type());
+  }
+}
+BENCHMARK(BM_AnyType);
+
+void BM_AnyCastHit(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(AnyCast<int>(&a));
+  }
+}
+BENCHMARK(BM_AnyCastHit);
+
+void BM_AnyCastMiss(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(AnyCast<long>(&a));
+  }
+}
+BENCHMARK(BM_AnyCastMiss);
+
+void BM_AnyCopyInternal(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    Any b = a;
+    benchmark::DoNotOptimize(b);
+  }
+}
+BENCHMARK(BM_AnyCopyInternal);
+
+void BM_AnyCopyExternal(benchmark::State& state) {
+  Any a = std::string("a string too long for the small buffer");
+  for (auto _ : state) {
+    Any b = a;
+    benchmark::DoNotOptimize(b);
+  }
+}
+BENCHMARK(BM_AnyCopyExternal);
+
+void BM_AnyMoveInternal(benchmark::State& state) {
+  Any a = 42;
+  for (auto _ : state) {
+    Any b = std::move(a);
+    a = std::move(b);
+    benchmark::DoNotOptimize(a);
+  }
+}
+BENCHMARK(BM_AnyMoveInternal);
+
+void BM_AnyMoveExternal(benchmark::State& state) {
+  Any a = std::string("a string too long for the small buffer");
+  for (auto _ : state) {
+    Any b = std::move(a);
+    a = std::move(b);
+    benchmark::DoNotOptimize(a);
+  }
+}
+BENCHMARK(BM_AnyMoveExternal);
+
+void BM_AnySwap(benchmark::State& state) {
+  Any a = 42;
+  Any b = std::string("a string too long for the small buffer");
+  for (auto _ : state) {
+    a.Swap(b);
+    benchmark::DoNotOptimize(a);
+  }
+}
+BENCHMARK(BM_AnySwap);
+
+// std::sort moves elements in and out of a temporary, so it runs mostly move
+// constructors and move assignments.
+template <typename AnyType, typename Tp>
+void BM_AnySort(benchmark::State& state) {
+  const std::vector<AnyType> input = MakeVector<AnyType, Tp>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<AnyType> v = input;
+    state.ResumeTiming();
+    std::sort(v.begin(), v.end(), [](const AnyType& lhs, const AnyType& rhs) {
+      return *AnyCast<Tp>(&lhs) < *AnyCast<Tp>(&rhs);
+    });
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// in place and trivially copyable
+BENCHMARK_TEMPLATE(BM_AnySort, Any, int)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(BM_AnySort, Any32, Vec2)->Arg(1 << 12);
+// on the heap
+BENCHMARK_TEMPLATE(BM_AnySort, Any, std::string)->Arg(1 << 12);
+// in place, and std::string points into itself so it is never relocated
+BENCHMARK_TEMPLATE(BM_AnySort, Any32, std::string)->Arg(1 << 12);
+
+// std::shuffle swaps pairs of elements.
+template <typename AnyType, typename Tp>
+void BM_AnyShuffle(benchmark::State& state) {
+  std::vector<AnyType> v = MakeVector<AnyType, Tp>(state.range(0));
+  std::mt19937 rng(7);
+  for (auto _ : state) {
+    std::shuffle(v.begin(), v.end(), rng);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_AnyShuffle, Any, int)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(BM_AnyShuffle, Any32, Vec2)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(BM_AnyShuffle, Any, std::string)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(BM_AnyShuffle, Any32, std::string)->Arg(1 << 12);
+
+}  // namespace
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "any.hpp"
+
+namespace cpp_idioms {
+
+class UnlistedElementType : public std::exception {
+ public:
+  virtual const char* what() const noexcept override {
+    return "the collection holds elements of types that were not listed";
+  }
+};
+
+// A heterogeneous container that keeps the elements of each concrete type in
+// a contiguous segment of their own, e.g. for a stream of mixed events.
+//
+// Compared to a std::vector<Any>, visiting the elements of one type neither
+// looks at a type nor follows a pointer per element, and the loop body is
+// inlined into the traversal. In return elements only keep their insertion
+// order within their segment, not across segments.
+//
+//   AnyCollection events;
+//   events.Insert(KeyEvent{'a'});
+//   events.Emplace<MouseEvent>(10, 20);
+//   events.ForEach<KeyEvent, MouseEvent>(Overloaded{
+//       [](KeyEvent& e) { ... },
+//       [](MouseEvent& e) { ... }});
+//
+// with Overloaded from overloaded.hpp.
+class AnyCollection {
+  // Each segment is a std::vector<Tp> in an any object large enough to hold
+  // it in place, std::vector<Tp> has the same size for every Tp.
+  using Segment =
+      BasicAny<sizeof(std::vector<char>), alignof(std::vector<char>)>;
+
+  template <typename Tp>
+  static constexpr void CheckElementType() {
+    static_assert(std::is_same_v<std::decay_t<Tp>, Tp>,
+                  "Elements must be of a non-reference, non-cv object type");
+    static_assert(std::is_copy_constructible_v<Tp>,
+                  "Elements must be CopyConstructible, like values in an Any");
+    static_assert(Segment::IsStoredInline<std::vector<Tp>>());
+  }
+
+ public:
+  // modifiers
+
+  // Insert a copy of value at the end of the segment of its type.
+  template <typename ValueType, typename Tp = std::decay_t<ValueType>>
+  Tp& Insert(ValueType&& value) {
+    return Emplace<Tp>(std::forward<ValueType>(value));
+  }
+
+  /// Insert an object created from @p Args at the end of the segment of Tp.
+  template <typename Tp, typename... Args>
+  Tp& Emplace(Args&&... args) {
+    CheckElementType<Tp>();
+    std::vector<Tp>& segment = GetOrAddSegment<Tp>();
+    Tp& element = segment.emplace_back(std::forward<Args>(args)...);
+    ++size_;
+    return element;
+  }
+
+  // Make room for n elements of type Tp.
+  template <typename Tp>
+  void Reserve(std::size_t n) {
+    CheckElementType<Tp>();
+    GetOrAddSegment<Tp>().reserve(n);
+  }
+
+  // Remove all elements
+  void Clear() noexcept {
+    segments_.clear();
+    size_ = 0;
+  }
+
+  // traversal
+
+  /// Call @p f with every element, one segment after another. The listed
+  /// types must cover the types of all elements, otherwise this throws
+  /// UnlistedElementType before calling @p f. Given more than one type,
+  /// @p f is a visitor with an overload for each of them.
+  template <typename... Ts, typename F>
+  void ForEach(F&& f) {
+    static_assert(sizeof...(Ts) > 0, "List the element types to visit");
+    if (!Covers<Ts...>()) throw UnlistedElementType();
+    (ForEachIn<Ts>(f), ...);
+  }
+
+  template <typename... Ts, typename F>
+  void ForEach(F&& f) const {
+    static_assert(sizeof...(Ts) > 0, "List the element types to visit");
+    if (!Covers<Ts...>()) throw UnlistedElementType();
+    (ForEachIn<Ts>(f), ...);
+  }
+
+  /// Call @p f with the elements of the listed types only, e.g. to visit
+  /// one segment. Elements of other types are skipped.
+  template <typename... Ts, typename F>
+  void ForEachOf(F&& f) {
+    static_assert(sizeof...(Ts) > 0, "List the element types to visit");
+    (ForEachIn<Ts>(f), ...);
+  }
+
+  template <typename... Ts, typename F>
+  void ForEachOf(F&& f) const {
+    static_assert(sizeof...(Ts) > 0, "List the element types to visit");
+    (ForEachIn<Ts>(f), ...);
+  }
+
+  // observers
+
+  // The number of elements
+  std::size_t Size() const noexcept { return size_; }
+
+  // The number of elements of type Tp
+  template <typename Tp>
+  std::size_t Size() const noexcept {
+    const std::vector<Tp>* segment = FindSegment<Tp>();
+    return segment ? segment->size() : 0;
+  }
+
+  bool Empty() const noexcept { return size_ == 0; }
+
+  // Whether there is a segment for type Tp
+  template <typename Tp>
+  bool Contains() const noexcept {
+    return FindSegment<Tp>() != nullptr;
+  }
+
+  // Whether every element is of one of the types Ts
+  template <typename... Ts>
+  bool Covers() const noexcept {
+    std::size_t covered = 0;
+    for (const Segment& segment : segments_) {
+      std::size_t size = 0;
+      (SizeIfOf<Ts>(segment, &size) || ...);
+      covered += size;
+    }
+    return covered == size_;
+  }
+
+ private:
+  template <typename Tp, typename F>
+  void ForEachIn(F& f) {
+    if (std::vector<Tp>* segment = FindSegment<Tp>()) {
+      for (Tp& element : *segment) f(element);
+    }
+  }
+
+  template <typename Tp, typename F>
+  void ForEachIn(F& f) const {
+    if (const std::vector<Tp>* segment = FindSegment<Tp>()) {
+      for (const Tp& element : *segment) f(element);
+    }
+  }
+
+  // Whether segment holds Tp elements, of which there are *size.
+  template <typename Tp>
+  static bool SizeIfOf(const Segment& segment, std::size_t* size) noexcept {
+    const std::vector<Tp>* elements = AnyCast<std::vector<Tp>>(&segment);
+    if (elements) *size = elements->size();
+    return elements != nullptr;
+  }
+
+  // Collections hold few types, a linear search beats hashing here.
+  template <typename Tp>
+  const std::vector<Tp>* FindSegment() const noexcept {
+    for (const Segment& segment : segments_) {
+      if (auto* elements = AnyCast<std::vector<Tp>>(&segment)) return elements;
+    }
+    return nullptr;
+  }
+
+  template <typename Tp>
+  std::vector<Tp>* FindSegment() noexcept {
+    return const_cast<std::vector<Tp>*>(
+        static_cast<const AnyCollection*>(this)->FindSegment<Tp>());
+  }
+
+  template <typename Tp>
+  std::vector<Tp>& GetOrAddSegment() {
+    if (std::vector<Tp>* segment = FindSegment<Tp>()) return *segment;
+    Segment& segment =
+        segments_.emplace_back(std::in_place_type<std::vector<Tp>>);
+    return *AnyCast<std::vector<Tp>>(&segment);
+  }
+
+  std::vector<Segment> segments_;
+  std::size_t size_ = 0;
+};
+
+}  // namespace cpp_idioms
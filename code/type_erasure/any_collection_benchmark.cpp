@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "any_collection.hpp"
+#include "overloaded.hpp"
+
+namespace {
+
+using cpp_idioms::Any;
+using cpp_idioms::AnyCast;
+using cpp_idioms::AnyCollection;
+using cpp_idioms::Overloaded;
+
+struct KeyEvent {
+  int key;
+  int modifiers;
+};
+
+struct MouseEvent {
+  int x;
+  int y;
+  int buttons;
+};
+
+struct TimerEvent {
+  long id;
+  double elapsed;
+};
+
+// The same random mix of events goes into both containers.
+template <typename Container>
+void Fill(Container* events, std::size_t size) {
+  std::mt19937 rng(42);
+  for (std::size_t i = 0; i < size; ++i) {
+    int n = static_cast<int>(rng());
+    switch (n % 3) {
+      case 0:
+        events->push_back(KeyEvent{n, 1});
+        break;
+      case 1:
+        events->push_back(MouseEvent{n, n, 2});
+        break;
+      default:
+        events->push_back(TimerEvent{n, 0.5});
+        break;
+    }
+  }
+}
+
+struct EventCollection {
+  template <typename Tp>
+  void push_back(Tp&& value) {
+    events.Insert(std::forward<Tp>(value));
+  }
+
+  AnyCollection events;
+};
+
+void BM_VectorOfAnyForEach(benchmark::State& state) {
+  std::vector<Any> events;
+  Fill(&events, state.range(0));
+  for (auto _ : state) {
+    long sum = 0;
+    for (const Any& event : events) {
+      if (auto* key = AnyCast<KeyEvent>(&event)) {
+        sum += key->key;
+      } else if (auto* mouse = AnyCast<MouseEvent>(&event)) {
+        sum += mouse->x + mouse->y;
+      } else if (auto* timer = AnyCast<TimerEvent>(&event)) {
+        sum += timer->id;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorOfAnyForEach)->Arg(1 << 10)->Arg(1 << 16);
+
+void BM_AnyCollectionForEach(benchmark::State& state) {
+  EventCollection collection;
+  Fill(&collection, state.range(0));
+  for (auto _ : state) {
+    long sum = 0;
+    collection.events.ForEach<KeyEvent, MouseEvent, TimerEvent>(Overloaded{
+        [&](const KeyEvent& key) { sum += key.key; },
+        [&](const MouseEvent& mouse) { sum += mouse.x + mouse.y; },
+        [&](const TimerEvent& timer) { sum += timer.id; }});
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyCollectionForEach)->Arg(1 << 10)->Arg(1 << 16);
+
+// Visiting a single type only touches its segment.
+void BM_VectorOfAnyForEachOfType(benchmark::State& state) {
+  std::vector<Any> events;
+  Fill(&events, state.range(0));
+  for (auto _ : state) {
+    long sum = 0;
+    for (const Any& event : events) {
+      if (auto* mouse = AnyCast<MouseEvent>(&event)) sum += mouse->x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorOfAnyForEachOfType)->Arg(1 << 16);
+
+void BM_AnyCollectionForEachOfType(benchmark::State& state) {
+  EventCollection collection;
+  Fill(&collection, state.range(0));
+  for (auto _ : state) {
+    long sum = 0;
+    collection.events.ForEachOf<MouseEvent>(
+        [&](const MouseEvent& mouse) { sum += mouse.x; });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyCollectionForEachOfType)->Arg(1 << 16);
+
+void BM_VectorOfAnyInsert(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<Any> events;
+    Fill(&events, state.range(0));
+    benchmark::DoNotOptimize(events.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorOfAnyInsert)->Arg(1 << 16);
+
+void BM_AnyCollectionInsert(benchmark::State& state) {
+  for (auto _ : state) {
+    EventCollection collection;
+    Fill(&collection, state.range(0));
+    benchmark::DoNotOptimize(collection.events.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyCollectionInsert)->Arg(1 << 16);
+
+}  // namespace
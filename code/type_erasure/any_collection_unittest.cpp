@@ -0,0 +1,92 @@
+#include "any_collection.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "overloaded.hpp"
+
+namespace cpp_idioms {
+namespace {
+
+struct KeyEvent {
+  char key;
+};
+
+struct MouseEvent {
+  int x;
+  int y;
+};
+
+TEST(AnyCollection, InsertGroupsByType) {
+  AnyCollection c;
+  EXPECT_TRUE(c.Empty());
+  c.Insert(KeyEvent{'a'});
+  c.Insert(MouseEvent{1, 2});
+  c.Emplace<KeyEvent>(KeyEvent{'b'});
+  MouseEvent& m = c.Emplace<MouseEvent>(MouseEvent{3, 4});
+  m.x = 5;
+
+  EXPECT_EQ(4u, c.Size());
+  EXPECT_EQ(2u, c.Size<KeyEvent>());
+  EXPECT_EQ(2u, c.Size<MouseEvent>());
+  EXPECT_EQ(0u, c.Size<int>());
+  EXPECT_FALSE(c.Contains<int>());
+
+  std::string keys;
+  c.ForEachOf<KeyEvent>([&](KeyEvent& e) { keys += e.key; });
+  EXPECT_EQ("ab", keys);
+
+  std::vector<int> xs;
+  c.ForEachOf<MouseEvent>([&](const MouseEvent& e) { xs.push_back(e.x); });
+  EXPECT_EQ((std::vector<int>{1, 5}), xs);
+}
+
+TEST(AnyCollection, VisitorForEach) {
+  AnyCollection c;
+  c.Insert(1);
+  c.Insert(std::string("two"));
+  c.Insert(3);
+  c.Insert(4.0);
+
+  int ints = 0;
+  std::string strings;
+  c.ForEachOf<int, std::string, long>(
+      Overloaded{[&](int& i) { ints += i; },
+                 [&](std::string& s) { strings += s; },
+                 [&](long&) { FAIL() << "no longs were inserted"; }});
+  EXPECT_EQ(4, ints);
+  EXPECT_EQ("two", strings);
+
+  // doubles are not listed: ForEach visits nothing, ForEachOf skips them
+  int visited = 0;
+  const AnyCollection& view = c;
+  EXPECT_FALSE((view.Covers<int, std::string>()));
+  EXPECT_THROW(
+      (view.ForEach<int, std::string>([&](const auto&) { ++visited; })),
+      UnlistedElementType);
+  EXPECT_EQ(0, visited);
+  view.ForEachOf<int, std::string>([&](const auto&) { ++visited; });
+  EXPECT_EQ(3, visited);
+  EXPECT_TRUE((view.Covers<double, int, std::string>()));
+}
+
+TEST(AnyCollection, CopyAndClear) {
+  AnyCollection c;
+  c.Reserve<std::string>(8);
+  c.Insert(std::string("x"));
+  c.Insert(KeyEvent{'k'});
+
+  AnyCollection copy = c;
+  c.ForEachOf<std::string>([](std::string& s) { s = "changed"; });
+  c.Clear();
+  EXPECT_TRUE(c.Empty());
+  EXPECT_EQ(0u, c.Size<std::string>());
+
+  EXPECT_EQ(2u, copy.Size());
+  copy.ForEachOf<std::string>([](std::string& s) { EXPECT_EQ("x", s); });
+}
+
+}  // namespace
+}  // namespace cpp_idioms
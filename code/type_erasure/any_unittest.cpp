@@ -0,0 +1,403 @@
+#include "any.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "utils/allocation_counter.hpp"
+
+namespace cpp_idioms {
+namespace {
+
+struct Vec2 {
+  double x;
+  double y;
+};
+
+struct Block {
+  char bytes[48];
+};
+
+struct ThrowingMove {
+  ThrowingMove() = default;
+  ThrowingMove(const ThrowingMove&) {}
+};
+
+// Forwards to the global operator new and counts what is outstanding.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  int Outstanding() const { return outstanding_; }
+  int Allocations() const { return allocations_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++outstanding_;
+    ++allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    --outstanding_;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  int outstanding_ = 0;
+  int allocations_ = 0;
+};
+
+// Can be moved but not copied.
+struct Handle {
+  explicit Handle(int fd) : fd(fd) {}
+  Handle(Handle&& other) noexcept : fd(other.fd) { other.fd = -1; }
+  Handle(const Handle&) = delete;
+
+  int fd;
+};
+
+// Counts move constructions.
+struct Tracked {
+  static int moves;
+
+  Tracked() = default;
+  Tracked(const Tracked&) = default;
+  Tracked(Tracked&& other) noexcept : value(other.value) { ++moves; }
+  Tracked& operator=(const Tracked&) = default;
+
+  int value = 0;
+};
+
+int Tracked::moves = 0;
+
+// Counts move constructions, but is allowed to be relocated with memcpy.
+struct Relocatable : Tracked {
+  using Tracked::Tracked;
+};
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Relocatable> : std::true_type {};
+
+namespace {
+
+using Any32 = BasicAny<32, alignof(std::max_align_t)>;
+using Any64 = BasicAny<64, alignof(std::max_align_t)>;
+
+static_assert(sizeof(Any) == 2 * sizeof(void*));
+static_assert(sizeof(pmr::Any) == 3 * sizeof(void*));
+static_assert(sizeof(Any32) == 32 + alignof(std::max_align_t));
+
+static_assert(Any::IsStoredInline<int>());
+static_assert(Any::IsStoredInline<void*>());
+static_assert(!Any::IsStoredInline<std::string>());
+static_assert(!Any::IsStoredInline<std::pair<int, double>>());
+static_assert(!Any::IsStoredInline<Vec2>());
+
+static_assert(Any32::IsStoredInline<std::string>());
+static_assert(Any32::IsStoredInline<std::pair<int, double>>());
+static_assert(Any32::IsStoredInline<Vec2>());
+static_assert(!Any32::IsStoredInline<Block>());
+static_assert(!Any32::IsStoredInline<ThrowingMove>());
+
+static_assert(Any64::IsStoredInline<Block>());
+
+static_assert(!std::is_constructible_v<Any, std::unique_ptr<int>>);
+static_assert(!std::is_constructible_v<Any, Handle>);
+static_assert(!std::is_copy_constructible_v<UniqueAny>);
+static_assert(std::is_nothrow_move_constructible_v<UniqueAny>);
+static_assert(std::is_constructible_v<UniqueAny, const Any&>);
+static_assert(!std::is_constructible_v<Any, UniqueAny>);
+static_assert(sizeof(UniqueAny) == sizeof(Any));
+
+static_assert(IsTriviallyRelocatable<int>::value);
+static_assert(IsTriviallyRelocatable<std::unique_ptr<Block>>::value);
+static_assert(!IsTriviallyRelocatable<Tracked>::value);
+static_assert(UniqueAny::IsStoredInline<std::unique_ptr<int>>());
+
+TEST(BasicAny, SmallTypesStayInternal) {
+  std::size_t before = AllocationCount();
+  Any32 a = Vec2{1.0, 2.0};
+  Any32 b = std::pair<int, double>{1, 2.0};
+  Any32 c = a;
+  Any32 d = std::move(b);
+  EXPECT_EQ(before, AllocationCount());
+  EXPECT_EQ(2.0, AnyCast<Vec2>(c).y);
+  EXPECT_EQ(1, (AnyCast<std::pair<int, double>>(d).first));
+  EXPECT_FALSE(b.HasValue());
+}
+
+TEST(BasicAny, LargeTypesGoToHeap) {
+  std::size_t before = AllocationCount();
+  Any a = Vec2{1.0, 2.0};
+  EXPECT_EQ(before + 1, AllocationCount());
+  Any b = a;
+  EXPECT_EQ(before + 2, AllocationCount());
+  Any c = std::move(a);
+  EXPECT_EQ(before + 2, AllocationCount());
+  EXPECT_EQ(1.0, AnyCast<Vec2>(c).x);
+  EXPECT_EQ(2.0, AnyCast<Vec2&>(b).y);
+}
+
+TEST(BasicAny, ThrowingMoveGoesToHeap) {
+  std::size_t before = AllocationCount();
+  Any64 a = ThrowingMove{};
+  EXPECT_EQ(before + 1, AllocationCount());
+  EXPECT_NE(nullptr, AnyCast<ThrowingMove>(&a));
+}
+
+TEST(BasicAny, MoveToLargerCapacityLeavesHeap) {
+  Any small = Vec2{3.0, 4.0};
+  std::size_t before = AllocationCount();
+  Any32 large = std::move(small);
+  EXPECT_EQ(before, AllocationCount());
+  EXPECT_FALSE(small.HasValue());
+  EXPECT_EQ(4.0, AnyCast<Vec2>(large).y);
+
+  Any32 copy = large;
+  EXPECT_EQ(before, AllocationCount());
+  EXPECT_EQ(3.0, AnyCast<Vec2>(copy).x);
+}
+
+TEST(BasicAny, MoveToSmallerCapacityAllocates) {
+  Any32 large = Vec2{5.0, 6.0};
+  std::size_t before = AllocationCount();
+  Any small = std::move(large);
+  EXPECT_EQ(before + 1, AllocationCount());
+  EXPECT_FALSE(large.HasValue());
+  EXPECT_EQ(5.0, AnyCast<Vec2>(small).x);
+}
+
+TEST(BasicAny, HeapObjectKeptBetweenSmallCapacities) {
+  BasicAny<16, 8> a = Block{{'x'}};
+  std::size_t before = AllocationCount();
+  Any b = std::move(a);
+  EXPECT_EQ(before, AllocationCount());
+  EXPECT_EQ('x', AnyCast<Block&>(b).bytes[0]);
+}
+
+TEST(BasicAny, ConvertingAssignment) {
+  Any32 large;
+  Any small = 42;
+  large = small;
+  EXPECT_EQ(42, AnyCast<int>(large));
+  EXPECT_TRUE(small.HasValue());
+
+  small = std::string("hello");
+  large = std::move(small);
+  EXPECT_EQ("hello", AnyCast<std::string&>(large));
+  EXPECT_FALSE(small.HasValue());
+
+  large = Any{};
+  EXPECT_FALSE(large.HasValue());
+}
+
+TEST(BasicAny, SwapAndType) {
+  Any32 a = std::string("a");
+  Any32 b = 1;
+  a.Swap(b);
+  EXPECT_EQ(typeid(int), a.Type());
+  EXPECT_EQ(typeid(std::string), b.Type());
+  Swap(a, b);
+  EXPECT_EQ("a", AnyCast<std::string>(a));
+  EXPECT_EQ(1, AnyCast<int>(b));
+
+  Any32 empty;
+  empty.Swap(a);
+  EXPECT_FALSE(a.HasValue());
+  EXPECT_EQ(typeid(void), a.Type());
+  EXPECT_EQ("a", AnyCast<std::string>(empty));
+}
+
+TEST(BasicAny, EmplaceReplacesValue) {
+  Any32 a = std::string("old");
+  std::string& s = a.emplace<std::string>(3, 'z');
+  EXPECT_EQ("zzz", s);
+  EXPECT_EQ(nullptr, AnyCast<int>(&a));
+  EXPECT_THROW(AnyCast<int>(a), BadAnyCast);
+}
+
+TEST(BasicAny, RelocatesWithoutMoveConstructor) {
+  Any a = Relocatable{};
+  AnyCast<Relocatable&>(a).value = 1;
+  Any b = 2;
+  Tracked::moves = 0;
+  Any c = std::move(a);
+  a = std::move(c);
+  a.Swap(b);
+  Swap(b, c);
+  EXPECT_EQ(0, Tracked::moves);
+  EXPECT_EQ(2, AnyCast<int>(a));
+  EXPECT_FALSE(b.HasValue());
+  EXPECT_EQ(1, AnyCast<Relocatable&>(c).value);
+}
+
+TEST(BasicAny, MovesObjectsThatAreNotRelocatable) {
+  Any a = Tracked{};
+  AnyCast<Tracked&>(a).value = 1;
+  Any b = 2;
+  Tracked::moves = 0;
+  Any c = std::move(a);
+  c.Swap(b);
+  EXPECT_EQ(2, Tracked::moves);
+  EXPECT_EQ(1, AnyCast<Tracked&>(b).value);
+
+  // std::string points into itself when kept in place
+  Any32 s = std::string("short");
+  Any32 t = std::move(s);
+  t.Swap(s);
+  EXPECT_EQ("short", AnyCast<std::string&>(s));
+  EXPECT_FALSE(t.HasValue());
+}
+
+TEST(PmrAny, HeapObjectsComeFromArena) {
+  alignas(std::max_align_t) char buffer[1024];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                            std::pmr::null_memory_resource());
+  std::size_t before = AllocationCount();
+  {
+    pmr::Any a(std::allocator_arg, &arena, Vec2{1.0, 2.0});
+    pmr::Any b(std::allocator_arg, &arena, a);
+    pmr::Any c(std::allocator_arg, &arena, std::in_place_type<Block>);
+    pmr::Any d = std::move(a);
+    EXPECT_EQ(&arena, d.GetMemoryResource());
+    EXPECT_EQ(2.0, AnyCast<Vec2>(d).y);
+    EXPECT_EQ(1.0, AnyCast<Vec2>(b).x);
+    b = Block{{'y'}};
+    EXPECT_EQ('y', AnyCast<Block&>(b).bytes[0]);
+  }
+  EXPECT_EQ(before, AllocationCount());
+}
+
+TEST(PmrAny, DestructionReturnsMemory) {
+  CountingResource resource;
+  {
+    pmr::Any a(std::allocator_arg, &resource, Vec2{1.0, 2.0});
+    EXPECT_EQ(1, resource.Outstanding());
+    a = 42;
+    EXPECT_EQ(0, resource.Outstanding());
+    a.emplace<Block>();
+    EXPECT_EQ(1, resource.Outstanding());
+  }
+  EXPECT_EQ(0, resource.Outstanding());
+}
+
+TEST(PmrAny, MoveBetweenResources) {
+  CountingResource first;
+  CountingResource second;
+  pmr::Any a(std::allocator_arg, &first, Vec2{1.0, 2.0});
+  pmr::Any b(std::allocator_arg, &first);
+  b = std::move(a);
+  // same resource, the heap object changes hands
+  EXPECT_EQ(1, first.Allocations());
+  EXPECT_EQ(1, first.Outstanding());
+
+  pmr::Any c(std::allocator_arg, &second);
+  c = std::move(b);
+  // another resource, the object is moved into a new allocation
+  EXPECT_EQ(0, first.Outstanding());
+  EXPECT_EQ(1, second.Outstanding());
+  EXPECT_EQ(&second, c.GetMemoryResource());
+  EXPECT_EQ(1.0, AnyCast<Vec2>(c).x);
+
+  pmr::Any d(std::allocator_arg, &first, Vec2{3.0, 4.0});
+  c.Swap(d);
+  EXPECT_EQ(1, first.Outstanding());
+  EXPECT_EQ(1, second.Outstanding());
+  EXPECT_EQ(3.0, AnyCast<Vec2>(c).x);
+  EXPECT_EQ(1.0, AnyCast<Vec2>(d).x);
+}
+
+TEST(PmrAny, CopiesStartOnDefaultResource) {
+  CountingResource resource;
+  pmr::Any a(std::allocator_arg, &resource, Vec2{1.0, 2.0});
+  pmr::Any b = a;
+  EXPECT_EQ(std::pmr::get_default_resource(), b.GetMemoryResource());
+  EXPECT_EQ(1, resource.Outstanding());
+
+  pmr::Any c(std::allocator_arg, &resource);
+  c = b;
+  EXPECT_EQ(&resource, c.GetMemoryResource());
+  EXPECT_EQ(2, resource.Outstanding());
+}
+
+TEST(PmrAny, ConvertsToAndFromAny) {
+  CountingResource resource;
+  Any a = Vec2{1.0, 2.0};
+  pmr::BasicAny<32, 16> b(std::allocator_arg, &resource, std::move(a));
+  EXPECT_EQ(0, resource.Allocations());
+  pmr::Any c(std::allocator_arg, &resource, std::move(b));
+  EXPECT_EQ(1, resource.Outstanding());
+  Any d = std::move(c);
+  EXPECT_EQ(0, resource.Outstanding());
+  EXPECT_EQ(2.0, AnyCast<Vec2>(d).y);
+}
+
+TEST(UniqueAny, HoldsMoveOnlyTypes) {
+  std::size_t before = AllocationCount();
+  UniqueAny a = std::make_unique<int>(7);
+  EXPECT_EQ(before + 1, AllocationCount());
+  UniqueAny b = std::move(a);
+  EXPECT_EQ(before + 1, AllocationCount());
+  EXPECT_FALSE(a.HasValue());
+  EXPECT_EQ(7, *UniqueAnyCast<std::unique_ptr<int>&>(b));
+  EXPECT_EQ(kTypeId<std::unique_ptr<int>>, b.GetTypeId());
+
+  UniqueAny c(std::in_place_type<Handle>, 3);
+  EXPECT_EQ(3, UniqueAnyCast<Handle&>(c).fd);
+  c.Swap(b);
+  EXPECT_EQ(3, UniqueAnyCast<const Handle&>(b).fd);
+  EXPECT_EQ(nullptr, UniqueAnyCast<Handle>(&c));
+}
+
+TEST(UniqueAny, CastMovesOut) {
+  UniqueAny a = std::make_unique<int>(1);
+  std::unique_ptr<int> p = UniqueAnyCast<std::unique_ptr<int>>(std::move(a));
+  EXPECT_EQ(1, *p);
+  // the moved-from object stays in the any
+  EXPECT_TRUE(a.HasValue());
+  EXPECT_EQ(nullptr, UniqueAnyCast<std::unique_ptr<int>&>(a));
+  EXPECT_THROW(UniqueAnyCast<int>(a), BadAnyCast);
+}
+
+TEST(UniqueAny, TakesStateOfAny) {
+  Any a = std::string("shared");
+  UniqueAny copy = a;
+  UniqueAny moved = std::move(a);
+  EXPECT_FALSE(a.HasValue());
+  EXPECT_EQ("shared", UniqueAnyCast<std::string>(copy));
+  EXPECT_EQ("shared", UniqueAnyCast<std::string&>(moved));
+
+  BasicUniqueAny<32, 8> large = std::move(moved);
+  large = Handle(5);
+  EXPECT_EQ(5, UniqueAnyCast<Handle&>(large).fd);
+  large.emplace<std::string>("again");
+  EXPECT_EQ("again", UniqueAnyCast<std::string&>(large));
+}
+
+TEST(UniqueAny, PmrHeapObjectsComeFromResource) {
+  CountingResource resource;
+  {
+    pmr::UniqueAny a(std::allocator_arg, &resource, std::in_place_type<Handle>,
+                     9);
+    EXPECT_EQ(0, resource.Allocations());
+    pmr::UniqueAny b(std::allocator_arg, &resource,
+                     std::make_unique<Block>());
+    pmr::BasicUniqueAny<8, 8> c(std::allocator_arg, &resource,
+                                std::in_place_type<Block>);
+    EXPECT_EQ(1, resource.Outstanding());
+    pmr::UniqueAny d = std::move(c);
+    EXPECT_EQ(&resource, d.GetMemoryResource());
+    EXPECT_EQ(1, resource.Outstanding());
+  }
+  EXPECT_EQ(0, resource.Outstanding());
+}
+
+}  // namespace
+}  // namespace cpp_idioms
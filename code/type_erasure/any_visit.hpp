@@ -0,0 +1,293 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "any.hpp"
+#include "overloaded.hpp"
+
+namespace cpp_idioms {
+
+namespace visit_internal {
+
+// The parameter type of the single, non-template, unary operator() of F, or
+// void for generic lambdas and other callables.
+template <typename Signature>
+struct ParameterOf {
+  using type = void;
+};
+
+template <typename R, typename C, typename A>
+struct ParameterOf<R (C::*)(A)> {
+  using type = A;
+};
+
+template <typename R, typename C, typename A>
+struct ParameterOf<R (C::*)(A) const> {
+  using type = A;
+};
+
+template <typename R, typename C, typename A>
+struct ParameterOf<R (C::*)(A) noexcept> {
+  using type = A;
+};
+
+template <typename R, typename C, typename A>
+struct ParameterOf<R (C::*)(A) const noexcept> {
+  using type = A;
+};
+
+template <typename F, typename = void>
+struct HandlerParameter {
+  using type = void;
+};
+
+template <typename F>
+struct HandlerParameter<F, std::void_t<decltype(&F::operator())>>
+    : ParameterOf<decltype(&F::operator())> {};
+
+// The handlers a visitor is made of.
+template <typename Visitor>
+struct Handlers {
+  using type = std::tuple<Visitor>;
+};
+
+template <typename... Fs>
+struct Handlers<Overloaded<Fs...>> {
+  using type = std::tuple<Fs...>;
+};
+
+// The alternatives of a handler, none or its parameter type.
+template <typename F,
+          typename Tp = std::decay_t<typename HandlerParameter<F>::type>>
+using AlternativesOf =
+    std::conditional_t<std::is_void_v<Tp> || IsBasicAny<Tp>::value,
+                       std::tuple<>, std::tuple<Tp>>;
+
+template <typename Tuple>
+struct Alternatives;
+
+template <typename... Fs>
+struct Alternatives<std::tuple<Fs...>> {
+  using type = decltype(std::tuple_cat(std::declval<AlternativesOf<Fs>>()...));
+};
+
+// Whether F takes an any object, of any type and in any way.
+template <typename F>
+using IsFallback =
+    IsBasicAny<std::decay_t<typename HandlerParameter<F>::type>>;
+
+// Whether F is no fallback, or one that takes an AnyType by reference and
+// so needs no conversion.
+template <typename F, typename AnyType,
+          typename Parameter = typename HandlerParameter<F>::type>
+using TakesAnyByReference = std::disjunction<
+    std::negation<IsFallback<F>>,
+    std::conjunction<std::is_reference<Parameter>,
+                     std::is_same<std::decay_t<Parameter>,
+                                  std::remove_const_t<AnyType>>>>;
+
+// Whether one of the handlers takes the any object itself.
+template <typename Tuple>
+struct HasFallback;
+
+template <typename... Fs>
+struct HasFallback<std::tuple<Fs...>> : std::disjunction<IsFallback<Fs>...> {};
+
+template <typename AnyType, typename Tuple>
+struct FallbackTakesAnyByReference;
+
+template <typename AnyType, typename... Fs>
+struct FallbackTakesAnyByReference<AnyType, std::tuple<Fs...>>
+    : std::conjunction<TakesAnyByReference<Fs, AnyType>...> {};
+
+// Where the id of an alternative goes in a dispatch table of |size| slots.
+constexpr std::size_t Slot(TypeId id, std::size_t size, unsigned shift) {
+  return static_cast<std::size_t>(id.Value() >> shift) & (size - 1);
+}
+
+struct TableShape {
+  std::size_t size;
+  unsigned shift;
+};
+
+// Find the smallest power-of-two table and the bits of the type ids that put
+// every alternative into a slot of its own. Type ids are hashes already, so
+// this takes a table of about twice the alternatives and a few tries.
+template <std::size_t N>
+constexpr TableShape FindTableShape(const std::array<TypeId, N>& ids) {
+  std::size_t size = 2;
+  while (size < 2 * N) size *= 2;
+  for (; size <= 1024 * (N + 1); size *= 2) {
+    const std::uint64_t max_index = ~std::uint64_t{0} / size;
+    for (unsigned shift = 0; (std::uint64_t{1} << shift) <= max_index;
+         ++shift) {
+      bool distinct = true;
+      for (std::size_t i = 0; i < N && distinct; ++i) {
+        for (std::size_t j = 0; j < i && distinct; ++j) {
+          distinct = ids[i] == ids[j] ||
+                     Slot(ids[i], size, shift) != Slot(ids[j], size, shift);
+        }
+      }
+      if (distinct) return {size, shift};
+    }
+  }
+  return {0, 0};
+}
+
+// Up to this many alternatives are tried one after another, which beats an
+// indirect call through the table.
+inline constexpr std::size_t kMaxChainedAlternatives = 8;
+
+// The dispatch of a visitor over the alternatives Ts, a chain of AnyCast
+// attempts for a few of them and otherwise a table from the type id of the
+// contained object to the handler of its type.
+template <typename AnyType, typename Visitor, typename... Ts>
+class Dispatcher {
+  template <typename Tp>
+  using Qualified =
+      std::conditional_t<std::is_const_v<AnyType>, const Tp, Tp>;
+
+  using VisitorHandlers = typename Handlers<std::decay_t<Visitor>>::type;
+
+  static constexpr bool kHasFallback = HasFallback<VisitorHandlers>::value;
+
+  static_assert(FallbackTakesAnyByReference<AnyType, VisitorHandlers>::value,
+                "A fallback handler takes the visited any object by "
+                "reference, any other parameter would convert or copy it");
+
+  template <typename Tp>
+  using ResultOf = std::invoke_result_t<Visitor&, Qualified<Tp>&>;
+
+  static constexpr auto ResultType() {
+    if constexpr (sizeof...(Ts) > 0) {
+      return std::common_type<ResultOf<Ts>...>{};
+    } else {
+      static_assert(kHasFallback, "The visitor handles no type");
+      return std::common_type<std::invoke_result_t<Visitor&, AnyType&>>{};
+    }
+  }
+
+ public:
+  using Result = typename decltype(ResultType())::type;
+
+  static Result Dispatch(Visitor& visitor, AnyType& any) {
+    if constexpr (sizeof...(Ts) <= kMaxChainedAlternatives) {
+      return Chain<Ts...>(visitor, any);
+    } else {
+      const TypeId id = any.GetTypeId();
+      const Entry& entry = kTable[Slot(id, kShape.size, kShape.shift)];
+      if (entry.id == id) return entry.handle(visitor, any);
+      return Fallback(visitor, any);
+    }
+  }
+
+ private:
+  using Handle = Result (*)(Visitor&, AnyType&);
+
+  struct Entry {
+    TypeId id;
+    Handle handle;
+  };
+
+  static Result Fallback(Visitor& visitor, AnyType& any) {
+    if constexpr (kHasFallback) {
+      return std::invoke(visitor, any);
+    } else {
+      ThrowBadAnyCast();
+    }
+  }
+
+  // Try the alternatives Us in turn.
+  template <typename... Us>
+  static Result Chain(Visitor& visitor, AnyType& any) {
+    if constexpr (sizeof...(Us) == 0) {
+      return Fallback(visitor, any);
+    } else {
+      return ChainFrom<Us...>(visitor, any);
+    }
+  }
+
+  template <typename Tp, typename... Us>
+  static Result ChainFrom(Visitor& visitor, AnyType& any) {
+    if (void* ptr = any_internal::AnyCaster<Tp>(&any)) {
+      return std::invoke(visitor, *static_cast<Qualified<Tp>*>(ptr));
+    }
+    return Chain<Us...>(visitor, any);
+  }
+
+  template <typename Tp>
+  static Result Call(Visitor& visitor, AnyType& any) {
+    void* ptr = any_internal::AnyCaster<Tp>(&any);
+    // the ids of two types are equal in theory
+    if (!ptr) return Fallback(visitor, any);
+    return std::invoke(visitor, *static_cast<Qualified<Tp>*>(ptr));
+  }
+
+  static constexpr std::array<TypeId, sizeof...(Ts)> kIds{kTypeId<Ts>...};
+
+  static constexpr TableShape kShape = FindTableShape(kIds);
+  static_assert(kShape.size != 0, "no dispatch table for these types");
+
+  static constexpr std::array<Handle, sizeof...(Ts)> kHandles{&Call<Ts>...};
+
+  static constexpr auto MakeTable() {
+    std::array<Entry, kShape.size> table{};
+    for (Entry& entry : table) entry = {TypeId(), &Fallback};
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+      Entry& entry = table[Slot(kIds[i], kShape.size, kShape.shift)];
+      // the first handler of a type listed twice wins
+      if (entry.handle == &Fallback) entry = {kIds[i], kHandles[i]};
+    }
+    return table;
+  }
+
+  static constexpr std::array<Entry, kShape.size> kTable = MakeTable();
+};
+
+template <typename AnyType, typename Visitor, typename Tuple>
+struct DispatcherOf;
+
+template <typename AnyType, typename Visitor, typename... Ts>
+struct DispatcherOf<AnyType, Visitor, std::tuple<Ts...>> {
+  using type = Dispatcher<AnyType, Visitor, Ts...>;
+};
+
+}  // namespace visit_internal
+
+/// Call @p visitor with the contained object of @p any.
+///
+/// The alternatives are the parameter types of the lambdas in an Overloaded
+/// visitor, or of a single lambda. Up to kMaxChainedAlternatives of them are
+/// tried in turn, more are looked up in a table built at compile time and
+/// indexed by the id of the contained type, so dispatch costs the same for
+/// nine alternatives or for thirty. A handler that takes the visited any
+/// object itself by reference is the fallback for empty objects and other
+/// types; without one those throw BadAnyCast.
+///
+///   Visit(any, Overloaded{
+///       [](int i) { ... },
+///       [](const std::string& s) { ... },
+///       [](const Any& other) { ... }});
+///
+/// Visitors with generic or several operator() list the alternatives
+/// explicitly, as in Visit<int, std::string>(any, visitor).
+template <typename... Ts, typename AnyType, typename Visitor,
+          std::enable_if_t<IsBasicAny<std::remove_const_t<AnyType>>::value,
+                           bool> = true>
+decltype(auto) Visit(AnyType& any, Visitor&& visitor) {
+  using Explicit = std::tuple<Ts...>;
+  using Deduced = typename visit_internal::Alternatives<
+      typename visit_internal::Handlers<std::decay_t<Visitor>>::type>::type;
+  using Dispatcher = typename visit_internal::DispatcherOf<
+      AnyType, std::remove_reference_t<Visitor>,
+      std::conditional_t<sizeof...(Ts) != 0, Explicit, Deduced>>::type;
+  return Dispatcher::Dispatch(visitor, any);
+}
+
+}  // namespace cpp_idioms
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "any_visit.hpp"
+
+namespace {
+
+using cpp_idioms::Any;
+using cpp_idioms::AnyCast;
+using cpp_idioms::Overloaded;
+using cpp_idioms::Visit;
+
+template <int I>
+struct Alternative {
+  int value;
+};
+
+template <int I>
+struct Handler {
+  long* sum;
+
+  void operator()(const Alternative<I>& alternative) const {
+    *sum += alternative.value + I;
+  }
+};
+
+// Objects of the N alternatives in random order.
+template <int... Is>
+std::vector<Any> MakeInput(std::integer_sequence<int, Is...>) {
+  constexpr int kAlternatives = sizeof...(Is);
+  using Factory = Any (*)(int);
+  constexpr Factory kFactories[] = {
+      [](int value) { return Any(Alternative<Is>{value}); }...};
+  std::mt19937 rng(42);
+  std::vector<Any> input;
+  for (int i = 0; i < (1 << 16); ++i) {
+    input.push_back(kFactories[rng() % kAlternatives](i));
+  }
+  return input;
+}
+
+// Try AnyCast for one alternative after another.
+template <int... Is>
+void BM_AnyCastChain(benchmark::State& state,
+                     std::integer_sequence<int, Is...> alternatives) {
+  std::vector<Any> input = MakeInput(alternatives);
+  for (auto _ : state) {
+    long sum = 0;
+    for (const Any& any : input) {
+      const Handler<0> fallback{&sum};
+      bool handled = ((AnyCast<Alternative<Is>>(&any)
+                           ? (Handler<Is>{&sum}(*AnyCast<Alternative<Is>>(&any)),
+                              true)
+                           : false) ||
+                      ...);
+      if (!handled) fallback(Alternative<0>{0});
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+template <int... Is>
+void BM_Visit(benchmark::State& state,
+              std::integer_sequence<int, Is...> alternatives) {
+  std::vector<Any> input = MakeInput(alternatives);
+  for (auto _ : state) {
+    long sum = 0;
+    Overloaded<Handler<Is>...> visitor{Handler<Is>{&sum}...};
+    for (const Any& any : input) Visit(any, visitor);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK_CAPTURE(BM_AnyCastChain, 2, std::make_integer_sequence<int, 2>());
+BENCHMARK_CAPTURE(BM_AnyCastChain, 8, std::make_integer_sequence<int, 8>());
+BENCHMARK_CAPTURE(BM_AnyCastChain, 32, std::make_integer_sequence<int, 32>());
+BENCHMARK_CAPTURE(BM_Visit, 2, std::make_integer_sequence<int, 2>());
+BENCHMARK_CAPTURE(BM_Visit, 8, std::make_integer_sequence<int, 8>());
+BENCHMARK_CAPTURE(BM_Visit, 32, std::make_integer_sequence<int, 32>());
+
+}  // namespace
@@ -0,0 +1,111 @@
+#include "any_visit.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace cpp_idioms {
+namespace {
+
+struct Point {
+  int x;
+  int y;
+};
+
+TEST(Visit, CallsHandlerOfContainedType) {
+  auto visitor = Overloaded{[](int i) { return "int " + std::to_string(i); },
+                            [](const std::string& s) { return "string " + s; },
+                            [](const Point& p) {
+                              return "point " + std::to_string(p.x);
+                            }};
+  Any a = 1;
+  EXPECT_EQ("int 1", Visit(a, visitor));
+  a = std::string("s");
+  EXPECT_EQ("string s", Visit(a, visitor));
+  a = Point{2, 3};
+  EXPECT_EQ("point 2", Visit(a, visitor));
+}
+
+TEST(Visit, FallbackTakesOtherTypes) {
+  auto visitor = Overloaded{[](int) { return 1; }, [](double) { return 2; },
+                            [](const Any& any) { return any.HasValue() ? 3 : 4; }};
+  EXPECT_EQ(1, Visit(static_cast<const Any&>(Any(5)), visitor));
+  Any a = 5.0;
+  EXPECT_EQ(2, Visit(a, visitor));
+  a = 'c';
+  EXPECT_EQ(3, Visit(a, visitor));
+  a.Reset();
+  EXPECT_EQ(4, Visit(a, visitor));
+}
+
+TEST(Visit, FallbackGetsTheVisitedObject) {
+  BasicAny<32, 8> a = 'c';
+  const BasicAny<32, 8>* seen = nullptr;
+  Visit(a, Overloaded{[](int) {},
+                      [&](const BasicAny<32, 8>& any) { seen = &any; }});
+  EXPECT_EQ(&a, seen);
+}
+
+TEST(Visit, ThrowsWithoutFallback) {
+  Any a = std::string("unhandled");
+  EXPECT_THROW(Visit(a, [](int) {}), BadAnyCast);
+  Any empty;
+  EXPECT_THROW(Visit(empty, [](int) {}), BadAnyCast);
+}
+
+TEST(Visit, HandlersCanModify) {
+  Any a = Point{1, 2};
+  Visit(a, Overloaded{[](Point& p) { p.x = 10; }, [](int&) {}});
+  EXPECT_EQ(10, AnyCast<Point&>(a).x);
+
+  UniqueAny u = std::string("unique");
+  Visit(u, [](std::string& s) { s += "!"; });
+  EXPECT_EQ("unique!", UniqueAnyCast<std::string&>(u));
+}
+
+TEST(Visit, ExplicitAlternativesForGenericVisitors) {
+  BasicAny<32, 8> a = std::string("abc");
+  auto size = [](const auto& value) -> std::size_t {
+    if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+      return value.size();
+    else
+      return sizeof(value);
+  };
+  EXPECT_EQ(3u, (Visit<int, std::string, Point>(a, size)));
+  a = Point{};
+  EXPECT_EQ(sizeof(Point), (Visit<int, std::string, Point>(a, size)));
+  a = 1.0;
+  EXPECT_THROW((Visit<int, std::string, Point>(a, size)), BadAnyCast);
+}
+
+template <int I>
+struct Tag {
+  static constexpr int kIndex = I;
+};
+
+// Visits with the alternatives Tag<0> to Tag<N - 1>.
+template <int... Is>
+int VisitTags(const Any& any, std::integer_sequence<int, Is...>) {
+  return Visit<Tag<Is>...>(any, [](const auto& tag) {
+    return std::decay_t<decltype(tag)>::kIndex;
+  });
+}
+
+TEST(Visit, LooksUpManyAlternativesInATable) {
+  constexpr auto kTags = std::make_integer_sequence<int, 12>();
+  Any a = Tag<0>{};
+  EXPECT_EQ(0, VisitTags(a, kTags));
+  a = Tag<7>{};
+  EXPECT_EQ(7, VisitTags(a, kTags));
+  a = Tag<11>{};
+  EXPECT_EQ(11, VisitTags(a, kTags));
+  a = Tag<12>{};
+  EXPECT_THROW(VisitTags(a, kTags), BadAnyCast);
+  a.Reset();
+  EXPECT_THROW(VisitTags(a, kTags), BadAnyCast);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "any.hpp"
+#include "utils/epoch.hpp"
+
+namespace cpp_idioms {
+
+// An any object that many threads read while another thread replaces it,
+// e.g. a configuration value that is reloaded at run time.
+//
+// Load() is wait-free and returns a snapshot of the current value, which
+// stays valid while the snapshot lives even if a new value is stored in the
+// meantime. Store() publishes a new value. Old values are destroyed once the
+// last snapshot that could see them is gone, through epoch-based
+// reclamation. Writers are serialized on a mutex that readers never touch.
+//
+//   AtomicAny config = Settings{...};
+//   // readers
+//   auto snapshot = config.Load();
+//   const Settings& settings = AnyCast<const Settings&>(*snapshot);
+//   // writer
+//   config.Store(LoadSettings());
+//
+// Snapshots must not outlive the AtomicAny, and one thread should not keep a
+// snapshot for long, since values retired in the meantime are kept with it.
+template <typename AnyType>
+class BasicAtomicAny {
+ public:
+  // A read-only view of the value at the time of Load().
+  class Snapshot {
+   public:
+    Snapshot(Snapshot&& other) noexcept
+        : slot_(std::exchange(other.slot_, nullptr)), value_(other.value_) {}
+    Snapshot& operator=(Snapshot&&) = delete;
+
+    ~Snapshot() {
+      if (slot_) EpochDomain::Default().Exit(slot_);
+    }
+
+    const AnyType& operator*() const noexcept { return *value_; }
+    const AnyType* operator->() const noexcept { return value_; }
+
+   private:
+    friend class BasicAtomicAny;
+
+    Snapshot(EpochDomain::Slot* slot, const AnyType* value) noexcept
+        : slot_(slot), value_(value) {}
+
+    EpochDomain::Slot* slot_;
+    const AnyType* value_;
+  };
+
+  // Start with an empty value.
+  BasicAtomicAny() : value_(new AnyType()) {}
+
+  // Start with value, an any object or a value to construct one from.
+  template <typename ValueType,
+            std::enable_if_t<!std::is_same_v<std::decay_t<ValueType>,
+                                             BasicAtomicAny>,
+                             bool> = true>
+  BasicAtomicAny(ValueType&& value)
+      : value_(new AnyType(std::forward<ValueType>(value))) {}
+
+  BasicAtomicAny(const BasicAtomicAny&) = delete;
+  BasicAtomicAny& operator=(const BasicAtomicAny&) = delete;
+
+  ~BasicAtomicAny() {
+    delete value_.load(std::memory_order_relaxed);
+    for (const Retired& retired : retired_) delete retired.value;
+  }
+
+  // A snapshot of the current value, wait-free. Throws std::bad_alloc if the
+  // first Load() on a thread cannot allocate the epoch slot of the thread.
+  Snapshot Load() const {
+    EpochDomain::Slot* slot = EpochDomain::Default().Enter();
+    return Snapshot(slot, value_.load(std::memory_order_acquire));
+  }
+
+  // Publish value, an any object or a value to construct one from. Readers
+  // see either the old or the new value, never a torn one.
+  template <typename ValueType>
+  void Store(ValueType&& value) {
+    std::unique_ptr<AnyType> next(new AnyType(std::forward<ValueType>(value)));
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    // room for the old value before it is unpublished, which readers may
+    // still see and so cannot be freed if this throws
+    retired_.push_back({0, nullptr});
+    Retired& retired = retired_.back();
+    retired.value = value_.exchange(next.release(), std::memory_order_seq_cst);
+    retired.epoch = EpochDomain::Default().Advance();
+    ReclaimLocked();
+  }
+
+  // Destroy the old values no reader can see anymore, and return how many
+  // are still kept for readers. Store() does this too.
+  std::size_t Reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    ReclaimLocked();
+    return retired_.size();
+  }
+
+ private:
+  struct Retired {
+    std::uint64_t epoch;
+    AnyType* value;
+  };
+
+  void ReclaimLocked() {
+    const std::uint64_t oldest = EpochDomain::Default().OldestReader();
+    std::size_t kept = 0;
+    for (const Retired& retired : retired_) {
+      if (retired.epoch < oldest) {
+        delete retired.value;
+      } else {
+        retired_[kept++] = retired;
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  std::atomic<AnyType*> value_;
+  std::mutex writer_mutex_;
+  // Values that were replaced, oldest first.
+  std::vector<Retired> retired_;
+};
+
+using AtomicAny = BasicAtomicAny<Any>;
+
+}  // namespace cpp_idioms
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <string>
+
+#include "atomic_any.hpp"
+
+namespace {
+
+using cpp_idioms::Any;
+using cpp_idioms::AnyCast;
+using cpp_idioms::AtomicAny;
+
+struct Settings {
+  int timeout_ms;
+  int retries;
+  std::string endpoint;
+};
+
+Settings MakeSettings(int version) {
+  return Settings{100 + version, 3, "https://example.com/api"};
+}
+
+// An any object behind a mutex, the way it is shared without AtomicAny.
+class MutexAny {
+ public:
+  explicit MutexAny(Any value) : value_(std::move(value)) {}
+
+  template <typename Fn>
+  auto Read(Fn fn) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fn(value_);
+  }
+
+  void Store(Any value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    value_ = std::move(value);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  Any value_;
+};
+
+AtomicAny atomic_settings = MakeSettings(0);
+MutexAny mutex_settings(MakeSettings(0));
+
+void BM_AtomicAnyRead(benchmark::State& state) {
+  long sum = 0;
+  for (auto _ : state) {
+    auto snapshot = atomic_settings.Load();
+    sum += AnyCast<const Settings&>(*snapshot).timeout_ms;
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AtomicAnyRead)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_MutexAnyRead(benchmark::State& state) {
+  long sum = 0;
+  for (auto _ : state) {
+    sum += mutex_settings.Read([](const Any& value) {
+      return AnyCast<const Settings&>(value).timeout_ms;
+    });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutexAnyRead)->ThreadRange(1, 8)->UseRealTime();
+
+// Thread 0 keeps publishing new values while the others read.
+void BM_AtomicAnyReadWhileWriting(benchmark::State& state) {
+  int version = 0;
+  long sum = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      atomic_settings.Store(MakeSettings(++version));
+    } else {
+      auto snapshot = atomic_settings.Load();
+      sum += AnyCast<const Settings&>(*snapshot).timeout_ms;
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_AtomicAnyReadWhileWriting)->ThreadRange(2, 8)->UseRealTime();
+
+void BM_MutexAnyReadWhileWriting(benchmark::State& state) {
+  int version = 0;
+  long sum = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      mutex_settings.Store(MakeSettings(++version));
+    } else {
+      sum += mutex_settings.Read([](const Any& value) {
+        return AnyCast<const Settings&>(value).timeout_ms;
+      });
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_MutexAnyReadWhileWriting)->ThreadRange(2, 8)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,121 @@
+#include "atomic_any.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+// A value that checks it is read while alive and counts live instances.
+struct Config {
+  static constexpr std::uint64_t kAlive = 0x600d600d600d600dull;
+  static constexpr std::uint64_t kDead = 0xdeaddeaddeaddeadull;
+  static std::atomic<int> live;
+
+  explicit Config(std::uint64_t version)
+      : version(version), checksum(~version) {
+    ++live;
+  }
+  Config(const Config& other)
+      : version(other.version), checksum(other.checksum) {
+    ++live;
+  }
+  ~Config() {
+    magic = kDead;
+    --live;
+  }
+
+  bool Valid() const { return magic == kAlive && checksum == ~version; }
+
+  std::uint64_t magic = kAlive;
+  std::uint64_t version;
+  std::uint64_t checksum;
+};
+
+std::atomic<int> Config::live{0};
+
+TEST(AtomicAny, LoadAndStore) {
+  AtomicAny value;
+  EXPECT_FALSE(value.Load()->HasValue());
+  value.Store(42);
+  EXPECT_EQ(42, AnyCast<int>(*value.Load()));
+  value.Store(Any(std::string("text")));
+  EXPECT_EQ("text", AnyCast<const std::string&>(*value.Load()));
+  EXPECT_EQ(0u, value.Reclaim());
+}
+
+TEST(AtomicAny, SnapshotKeepsValueAlive) {
+  {
+    AtomicAny value = Config(1);
+    auto snapshot = value.Load();
+    value.Store(Config(2));
+    value.Store(Config(3));
+    // both replaced values may still be seen through the snapshot
+    EXPECT_EQ(2u, value.Reclaim());
+    EXPECT_EQ(3, Config::live);
+    EXPECT_EQ(1u, AnyCast<const Config&>(*snapshot).version);
+    EXPECT_TRUE(AnyCast<const Config&>(*snapshot).Valid());
+
+    {
+      // a nested load does not announce a new epoch
+      auto nested = value.Load();
+      EXPECT_EQ(3u, AnyCast<const Config&>(*nested).version);
+    }
+    EXPECT_EQ(2u, value.Reclaim());
+
+    auto moved = std::move(snapshot);
+    EXPECT_EQ(1u, AnyCast<const Config&>(*moved).version);
+  }
+  EXPECT_EQ(0, Config::live);
+}
+
+TEST(AtomicAny, ReleasedSnapshotsAllowReclamation) {
+  AtomicAny value = Config(1);
+  { auto snapshot = value.Load(); }
+  value.Store(Config(2));
+  EXPECT_EQ(0u, value.Reclaim());
+  EXPECT_EQ(1, Config::live);
+}
+
+// Readers check every value they see while a writer keeps replacing it.
+TEST(AtomicAny, StressReadersAndWriter) {
+  constexpr int kReaders = 4;
+  constexpr std::uint64_t kVersions = 20000;
+  {
+    AtomicAny value = Config(0);
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaders; ++i) {
+      readers.emplace_back([&] {
+        std::uint64_t last = 0;
+        while (!done.load(std::memory_order_acquire)) {
+          auto snapshot = value.Load();
+          const Config& config = AnyCast<const Config&>(*snapshot);
+          // versions only go up
+          if (!config.Valid() || config.version < last) ++torn;
+          last = config.version;
+        }
+      });
+    }
+    for (std::uint64_t version = 1; version <= kVersions; ++version) {
+      value.Store(Config(version));
+      if (version % 64 == 0) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) reader.join();
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_EQ(0u, value.Reclaim());
+    EXPECT_EQ(kVersions, AnyCast<const Config&>(*value.Load()).version);
+    EXPECT_EQ(1, Config::live);
+  }
+  EXPECT_EQ(0, Config::live);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
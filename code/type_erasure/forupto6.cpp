@@ -0,0 +1,17 @@
+#include <iostream>
+#include <vector>
+
+#include "function_ptr.hpp"
+
+// One call into the bridge for the whole loop
+void ForUpTo(int n, const FunctionPtr<void(int)>& f) { f.InvokeRange(0, n); }
+
+void PrintInt(int n) { std::cout << n << ' '; }
+int main() {
+  ForUpTo(5, PrintInt);
+
+  std::vector<int> v;
+  ForUpTo(5, [&v](int n) { v.push_back(n); });
+  std::cout << '\n';
+  return 0;
+}
@@ -1,27 +1,47 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
 
 #include "functor_bridge.hpp"
 #include "specific_functor_bridge.hpp"
 
+// The default inline capacity of FunctionPtr in bytes. The bridge keeps a
+// vtable pointer there too, which leaves room for three captured pointers or
+// references.
+inline constexpr std::size_t kFunctionPtrCapacity = 4 * sizeof(void*);
+
 // primary template
-template <typename Signature>
+template <typename Signature, std::size_t Capacity = kFunctionPtrCapacity>
 class FunctionPtr;
 
 // partial specialization
-template <typename R, typename... Args>
-class FunctionPtr<R(Args...)> {
+//
+// Functors whose bridge fits into Capacity bytes and that are nothrow
+// movable are stored inline, others are allocated on the heap.
+template <typename R, typename... Args, std::size_t Capacity>
+class FunctionPtr<R(Args...), Capacity> {
+  using Bridge = FunctorBridge<R, Args...>;
+
  public:
+  // Whether a functor of type Functor is stored without allocation
+  template <typename Functor>
+  static constexpr bool kFitsInline =
+      sizeof(SpecificFunctorBridge<Functor, R, Args...>) <= Capacity &&
+      alignof(SpecificFunctorBridge<Functor, R, Args...>) <= alignof(Bridge) &&
+      std::is_nothrow_move_constructible_v<Functor>;
+
   FunctionPtr() : bridge_{nullptr} {}
 
   FunctionPtr(const FunctionPtr&);
 
   FunctionPtr(FunctionPtr& other)
       : FunctionPtr(static_cast<FunctionPtr const&>(other)) {}
-  FunctionPtr(FunctionPtr&& other) : bridge_{other.bridge_} {
-    other.bridge_ = nullptr;
+  FunctionPtr(FunctionPtr&& other) noexcept : bridge_{nullptr} {
+    MoveFrom(other);
   }
 
   template <typename F>
@@ -34,10 +54,11 @@ class FunctionPtr<R(Args...)> {
     return *this;
   }
 
-  FunctionPtr& operator=(FunctionPtr&& other) {
-    delete bridge_;
-    bridge_ = other.bridge_;
-    other.bridge_ = nullptr;
+  FunctionPtr& operator=(FunctionPtr&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
     return *this;
   }
 
@@ -50,48 +71,106 @@ class FunctionPtr<R(Args...)> {
   }
 
   // destructor:
-  ~FunctionPtr() { delete bridge_; }
+  ~FunctionPtr() { Reset(); }
 
   friend bool operator==(const FunctionPtr& f1, const FunctionPtr& f2) {
     if (!f1 || !f2) {
       return !f1 && !f2;
     }
+    // functors with different types are never equal:
+    if (f1.bridge_->TypeTag() != f2.bridge_->TypeTag()) {
+      return false;
+    }
     return f1.bridge_->Equals(f2.bridge_);
   }
   friend bool operator!=(const FunctionPtr& f1, const FunctionPtr& f2) {
     return !(f1 == f2);
   }
 
-  friend void swap(FunctionPtr& fp1, FunctionPtr& fp2) {
-    std::swap(fp1.bridge_, fp2.bridge_);
+  friend void swap(FunctionPtr& fp1, FunctionPtr& fp2) noexcept {
+    if (!fp1.IsStoredInline() && !fp2.IsStoredInline()) {
+      std::swap(fp1.bridge_, fp2.bridge_);
+      return;
+    }
+    FunctionPtr temp(std::move(fp1));
+    fp1 = std::move(fp2);
+    fp2 = std::move(temp);
   }
 
-  explicit operator bool() const { return bridge_ == nullptr; }
+  explicit operator bool() const { return bridge_ != nullptr; }
+
+  // Whether the functor lives in the object itself
+  bool IsStoredInline() const noexcept {
+    return bridge_ == reinterpret_cast<const Bridge*>(buffer_);
+  }
 
   // invocation
   R operator()(Args... args) const;
 
+  // Invoke with each index of [first, last) in turn, discarding results.
+  // The loop runs inside the bridge, so the whole range costs one virtual
+  // call instead of one per index. Throws std::out_of_range for indices the
+  // parameter cannot hold.
+  void InvokeRange(std::ptrdiff_t first, std::ptrdiff_t last) const {
+    static_assert(kInvocableWithIndex<Args...>,
+                  "InvokeRange needs a single integral parameter");
+    if (first < last &&
+        !(IndexFits<Args...>(first) && IndexFits<Args...>(last - 1))) {
+      throw std::out_of_range("FunctionPtr::InvokeRange: index out of range");
+    }
+    bridge_->InvokeRange(first, last);
+  }
+
  private:
-  FunctorBridge<R, Args...>* bridge_;
+  void* Buffer() noexcept { return buffer_; }
+
+  void Reset() noexcept {
+    if (IsStoredInline()) {
+      bridge_->~Bridge();
+    } else {
+      delete bridge_;
+    }
+    bridge_ = nullptr;
+  }
+
+  // Take the functor of other, which is left empty
+  void MoveFrom(FunctionPtr& other) noexcept {
+    if (other.IsStoredInline()) {
+      bridge_ = other.bridge_->MoveInto(Buffer());
+      other.Reset();
+    } else {
+      bridge_ = other.bridge_;
+      other.bridge_ = nullptr;
+    }
+  }
+
+  Bridge* bridge_;
+  alignas(Bridge) unsigned char buffer_[Capacity];
 };
 
-template <typename R, typename... Args>
-FunctionPtr<R(Args...)>::FunctionPtr(const FunctionPtr& other)
+template <typename R, typename... Args, std::size_t Capacity>
+FunctionPtr<R(Args...), Capacity>::FunctionPtr(const FunctionPtr& other)
     : bridge_{nullptr} {
-  if (other.bridge_) {
+  if (other.IsStoredInline()) {
+    bridge_ = other.bridge_->CloneInto(Buffer());
+  } else if (other.bridge_) {
     bridge_ = other.bridge_->Clone();
   }
 }
 
-template <typename R, typename... Args>
-R FunctionPtr<R(Args...)>::operator()(Args... args) const {
+template <typename R, typename... Args, std::size_t Capacity>
+R FunctionPtr<R(Args...), Capacity>::operator()(Args... args) const {
   return bridge_->Invoke(std::forward<Args>(args)...);
 }
 
-template <typename R, typename... Args>
+template <typename R, typename... Args, std::size_t Capacity>
 template <typename F>
-FunctionPtr<R(Args...)>::FunctionPtr(F&& f) : bridge_{nullptr} {
+FunctionPtr<R(Args...), Capacity>::FunctionPtr(F&& f) : bridge_{nullptr} {
   using Functor = std::decay_t<F>;
-  using Bridge = SpecificFunctorBridge<Functor, R, Args...>;
-  bridge_ = new Bridge(std::forward<F>(f));
-}
\ No newline at end of file
+  using SpecificBridge = SpecificFunctorBridge<Functor, R, Args...>;
+  if constexpr (kFitsInline<Functor>) {
+    bridge_ = ::new (Buffer()) SpecificBridge(std::forward<F>(f));
+  } else {
+    bridge_ = new SpecificBridge(std::forward<F>(f));
+  }
+}
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "function_ptr.hpp"
+
+namespace {
+
+constexpr int kIterations = 100000000;
+
+// One virtual call per index, as in forupto4.
+__attribute__((noinline)) void ForUpTo(int n,
+                                       const FunctionPtr<void(int)>& f) {
+  for (int i = 0; i < n; ++i) {
+    f(i);
+  }
+}
+
+// One virtual call for the whole range, as in forupto6.
+__attribute__((noinline)) void ForUpToBatched(
+    int n, const FunctionPtr<void(int)>& f) {
+  f.InvokeRange(0, n);
+}
+
+template <void (*Loop)(int, const FunctionPtr<void(int)>&)>
+void BM_Sum(benchmark::State& state) {
+  long sum = 0;
+  const FunctionPtr<void(int)> f = [&sum](int n) { sum += n; };
+  for (auto _ : state) {
+    Loop(state.range(0), f);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_Sum, ForUpTo)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Sum, ForUpToBatched)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond);
+
+// A body that cannot be vectorized, only the calls are saved.
+template <void (*Loop)(int, const FunctionPtr<void(int)>&)>
+void BM_Hash(benchmark::State& state) {
+  unsigned long hash = 14695981039346656037ul;
+  const FunctionPtr<void(int)> f = [&hash](int n) {
+    hash = (hash ^ static_cast<unsigned>(n)) * 1099511628211ul;
+  };
+  for (auto _ : state) {
+    Loop(state.range(0), f);
+  }
+  benchmark::DoNotOptimize(hash);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_Hash, ForUpTo)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Hash, ForUpToBatched)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "function_ptr.hpp"
+
+namespace {
+
+// No functor fits besides the vtable pointer, every one is allocated.
+template <typename Signature>
+using HeapFunctionPtr = FunctionPtr<Signature, sizeof(void*)>;
+
+template <typename Function>
+__attribute__((noinline)) void ForUpTo(int n, Function f) {
+  for (int i = 0; i < n; ++i) {
+    f(i);
+  }
+}
+
+// Pass a lambda that captures one reference, as in forupto3/forupto4, and
+// make a few calls through it.
+template <typename Function>
+void BM_ForUpTo(benchmark::State& state) {
+  long sum = 0;
+  for (auto _ : state) {
+    ForUpTo<Function>(state.range(0), [&sum](int n) { sum += n; });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ForUpTo, std::function<void(int)>)->Arg(0)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpTo, HeapFunctionPtr<void(int)>)->Arg(0)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpTo, FunctionPtr<void(int)>)->Arg(0)->Arg(5);
+
+// A lambda with three captures, which std::function allocates.
+template <typename Function>
+void BM_ForUpToThreeCaptures(benchmark::State& state) {
+  long sum = 0;
+  long scale = 2;
+  long offset = 1;
+  for (auto _ : state) {
+    ForUpTo<Function>(state.range(0), [&sum, scale, offset](int n) {
+      sum += n * scale + offset;
+    });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ForUpToThreeCaptures, std::function<void(int)>)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpToThreeCaptures, HeapFunctionPtr<void(int)>)
+    ->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpToThreeCaptures, FunctionPtr<void(int)>)->Arg(5);
+
+// Copy a callback, e.g. into a queue of pending calls.
+template <typename Function>
+void BM_Copy(benchmark::State& state) {
+  Function f = [](int n) { benchmark::DoNotOptimize(n); };
+  for (auto _ : state) {
+    Function copy = f;
+    benchmark::DoNotOptimize(&copy);
+  }
+}
+BENCHMARK_TEMPLATE(BM_Copy, std::function<void(int)>);
+BENCHMARK_TEMPLATE(BM_Copy, HeapFunctionPtr<void(int)>);
+BENCHMARK_TEMPLATE(BM_Copy, FunctionPtr<void(int)>);
+
+void Log(int) {}
+void Count(int) {}
+
+// A comparable functor
+struct Forward {
+  int channel;
+  void operator()(int) const {}
+  bool operator==(const Forward& other) const {
+    return channel == other.channel;
+  }
+};
+
+// Look up callbacks in a subscriber list of functors of three types, as
+// when duplicates are dropped.
+void BM_FindSubscriber(benchmark::State& state) {
+  std::vector<FunctionPtr<void(int)>> subscribers;
+  for (int i = 0; i < state.range(0); ++i) {
+    subscribers.emplace_back(Forward{i});
+  }
+  subscribers.emplace_back(Log);
+  const FunctionPtr<void(int)> wanted[] = {Count, Log,
+                                           Forward{int(state.range(0)) - 1}};
+  for (auto _ : state) {
+    for (const FunctionPtr<void(int)>& callback : wanted) {
+      benchmark::DoNotOptimize(
+          std::find(subscribers.begin(), subscribers.end(), callback));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 3 * subscribers.size());
+}
+BENCHMARK(BM_FindSubscriber)->Arg(4096);
+
+}  // namespace
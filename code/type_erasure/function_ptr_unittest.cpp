@@ -0,0 +1,166 @@
+// Built with -fno-rtti: comparing FunctionPtrs must not need dynamic_cast.
+
+#include "function_ptr.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "utils/allocation_counter.hpp"
+
+namespace {
+
+using cpp_idioms::AllocationCount;
+
+int Twice(int n) { return 2 * n; }
+
+// Counts live instances.
+struct Counted {
+  static int live;
+  Counted() { ++live; }
+  Counted(const Counted&) { ++live; }
+  Counted(Counted&&) noexcept { ++live; }
+  ~Counted() { --live; }
+  int operator()(int n) const { return n + 1; }
+};
+
+int Counted::live = 0;
+
+// A functor that is copied instead of moved.
+struct ThrowingMove {
+  ThrowingMove() = default;
+  ThrowingMove(const ThrowingMove&) = default;
+  ThrowingMove(ThrowingMove&&) noexcept(false) {}
+  int operator()(int n) const { return n; }
+};
+
+TEST(FunctionPtr, SmallFunctorsDoNotAllocate) {
+  int base = 40;
+  std::size_t before = AllocationCount();
+  FunctionPtr<int(int)> f = [&base](int n) { return base + n; };
+  FunctionPtr<int(int)> g = Twice;
+  FunctionPtr<int(int)> copy = f;
+  FunctionPtr<int(int)> moved = std::move(g);
+  copy = moved;
+  EXPECT_EQ(before, AllocationCount());
+
+  EXPECT_TRUE(f.IsStoredInline());
+  EXPECT_TRUE(moved.IsStoredInline());
+  EXPECT_EQ(42, f(2));
+
+  // three references fit next to the vtable pointer of the bridge
+  int scale = 2, offset = 1;
+  auto three = [&base, &scale, &offset](int n) {
+    return base + scale * n + offset;
+  };
+  static_assert(FunctionPtr<int(int)>::kFitsInline<decltype(three)>);
+  before = AllocationCount();
+  FunctionPtr<int(int)> h = three;
+  EXPECT_EQ(before, AllocationCount());
+  EXPECT_TRUE(h.IsStoredInline());
+  EXPECT_EQ(45, h(2));
+  EXPECT_EQ(4, copy(2));
+  EXPECT_EQ(4, moved(2));
+  EXPECT_FALSE(g);
+}
+
+TEST(FunctionPtr, LargeFunctorsAreAllocated) {
+  std::array<int, 16> values{};
+  values[3] = 7;
+  auto lambda = [values](int n) { return values[n]; };
+  FunctionPtr<int(int)> f = lambda;
+  EXPECT_FALSE(f.IsStoredInline());
+  EXPECT_EQ(7, f(3));
+
+  // unless the capacity is raised
+  FunctionPtr<int(int), 128> large = lambda;
+  EXPECT_TRUE(large.IsStoredInline());
+  EXPECT_EQ(7, large(3));
+
+  FunctionPtr<int(int)> copy = f;
+  EXPECT_FALSE(copy.IsStoredInline());
+  EXPECT_EQ(7, copy(3));
+
+  EXPECT_FALSE(FunctionPtr<int(int)>(ThrowingMove{}).IsStoredInline());
+}
+
+TEST(FunctionPtr, DestroysFunctors) {
+  {
+    FunctionPtr<int(int)> inline_f = Counted{};
+    std::array<char, 64> padding{};
+    FunctionPtr<int(int)> heap_f = [c = Counted{}, padding](int n) {
+      return c(n) + padding[0];
+    };
+    EXPECT_EQ(2, Counted::live);
+    FunctionPtr<int(int)> copy = inline_f;
+    EXPECT_EQ(3, Counted::live);
+    copy = heap_f;
+    EXPECT_EQ(3, Counted::live);
+    swap(inline_f, heap_f);
+    EXPECT_EQ(3, Counted::live);
+    EXPECT_FALSE(inline_f.IsStoredInline());
+    EXPECT_TRUE(heap_f.IsStoredInline());
+    EXPECT_EQ(2, heap_f(1));
+    heap_f = FunctionPtr<int(int)>();
+    EXPECT_EQ(2, Counted::live);
+  }
+  EXPECT_EQ(0, Counted::live);
+}
+
+static_assert(kInvocableWithIndex<const long&>);
+static_assert(!kInvocableWithIndex<double>);
+static_assert(!kInvocableWithIndex<bool>);
+static_assert(!kInvocableWithIndex<int, int>);
+
+TEST(FunctionPtr, InvokesRanges) {
+  long sum = 0;
+  FunctionPtr<void(int)> add = [&sum](int n) { sum += n; };
+  add.InvokeRange(0, 100);
+  EXPECT_EQ(4950, sum);
+  add.InvokeRange(5, 5);
+  EXPECT_EQ(4950, sum);
+
+  // results are discarded, parameters need only accept an index
+  std::vector<short> seen;
+  FunctionPtr<bool(const short&)> record = [&seen](const short& x) {
+    seen.push_back(x);
+    return true;
+  };
+  record.InvokeRange(-2, 1);
+  EXPECT_EQ((std::vector<short>{-2, -1, 0}), seen);
+
+  // indices the parameter cannot hold are not narrowed
+  EXPECT_THROW(record.InvokeRange(0, 40000), std::out_of_range);
+  FunctionPtr<void(unsigned char)> byte = [&sum](unsigned char n) { sum += n; };
+  EXPECT_THROW(byte.InvokeRange(-1, 1), std::out_of_range);
+  EXPECT_THROW(byte.InvokeRange(250, 257), std::out_of_range);
+  byte.InvokeRange(255, 256);
+  byte.InvokeRange(-5, -5);
+  EXPECT_EQ(4950 + 255, sum);
+  EXPECT_EQ(3u, seen.size());
+}
+
+TEST(FunctionPtr, ComparesFunctors) {
+  FunctionPtr<int(int)> empty;
+  FunctionPtr<int(int)> f = Twice;
+  FunctionPtr<int(int)> g = f;
+  EXPECT_FALSE(empty);
+  EXPECT_TRUE(f);
+  EXPECT_TRUE(empty == FunctionPtr<int(int)>());
+  EXPECT_TRUE(f == g);
+  EXPECT_TRUE(f != empty);
+  // two closures of one scope, which have the same name
+  auto first = [](int n) { return n; };
+  auto second = [](int n) { return n; };
+  EXPECT_TRUE(FunctionPtr<int(int)>(first) != FunctionPtr<int(int)>(second));
+
+  EXPECT_THROW((void)(FunctionPtr<int(int)>(Counted{}) ==
+                      FunctionPtr<int(int)>(Counted{})),
+               NotEqualityComparable);
+}
+
+}  // namespace
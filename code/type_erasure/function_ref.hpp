@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// primary template
+template <typename Signature>
+class FunctionRef;
+
+// A non-owning reference to a callable, for parameters of functions that
+// only call it before they return.
+//
+//   void ForUpTo(int n, FunctionRef<void(int)> f);
+//   ForUpTo(5, [&v](int n) { v.push_back(n); });
+//
+// It is two pointers wide, an address of the callable and a trampoline that
+// calls it, never allocates, and is copied like a pointer. The callable
+// must outlive every call through the reference, so FunctionRef should not
+// be stored beyond the call that received it.
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+  // The address of a function object, or a pointer to a function
+  union Target {
+    void* object;
+    void (*function)();
+  };
+
+  template <typename F>
+  using EnableIfCallable = std::enable_if_t<
+      !std::is_same_v<std::decay_t<F>, FunctionRef> &&
+          std::is_invocable_r_v<R, F&, Args...>,
+      bool>;
+
+ public:
+  template <typename F, EnableIfCallable<F> = true>
+  FunctionRef(F&& f) noexcept {
+    using Callable = std::remove_reference_t<F>;
+    if constexpr (std::is_function_v<Callable>) {
+      target_.function = reinterpret_cast<void (*)()>(&f);
+      invoke_ = &InvokeFunction<Callable>;
+    } else if constexpr (std::is_pointer_v<Callable> &&
+                         std::is_function_v<std::remove_pointer_t<Callable>>) {
+      target_.function = reinterpret_cast<void (*)()>(f);
+      invoke_ = &InvokeFunction<std::remove_pointer_t<Callable>>;
+    } else {
+      target_.object = const_cast<void*>(
+          static_cast<const volatile void*>(std::addressof(f)));
+      invoke_ = &InvokeObject<Callable>;
+    }
+  }
+
+  R operator()(Args... args) const {
+    return invoke_(target_, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename Callable>
+  static R InvokeObject(Target target, Args... args) {
+    Callable& callable = *static_cast<Callable*>(target.object);
+    if constexpr (std::is_void_v<R>) {
+      std::invoke(callable, std::forward<Args>(args)...);
+    } else {
+      return std::invoke(callable, std::forward<Args>(args)...);
+    }
+  }
+
+  template <typename Function>
+  static R InvokeFunction(Target target, Args... args) {
+    Function* function = reinterpret_cast<Function*>(target.function);
+    if constexpr (std::is_void_v<R>) {
+      function(std::forward<Args>(args)...);
+    } else {
+      return function(std::forward<Args>(args)...);
+    }
+  }
+
+  Target target_;
+  R (*invoke_)(Target, Args...);
+};
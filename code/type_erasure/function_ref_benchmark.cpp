@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+#include "function_ptr.hpp"
+#include "function_ref.hpp"
+
+namespace {
+
+template <typename Function>
+__attribute__((noinline)) void ForUpTo(int n, Function f) {
+  for (int i = 0; i < n; ++i) {
+    f(i);
+  }
+}
+
+// Pass a lambda to ForUpTo as in forupto3, forupto4 and forupto5.
+template <typename Function>
+void BM_ForUpTo(benchmark::State& state) {
+  long sum = 0;
+  for (auto _ : state) {
+    ForUpTo<Function>(state.range(0), [&sum](int n) { sum += n; });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ForUpTo, std::function<void(int)>)->Arg(0)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpTo, FunctionPtr<void(int)>)->Arg(0)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpTo, FunctionRef<void(int)>)->Arg(0)->Arg(5);
+
+// A lambda too large for the inline storage of either owning wrapper.
+template <typename Function>
+void BM_ForUpToLargeCapture(benchmark::State& state) {
+  long sum = 0;
+  long a = 1, b = 2, c = 3, d = 4, e = 5;
+  for (auto _ : state) {
+    ForUpTo<Function>(state.range(0), [&sum, a, b, c, d, e](int n) {
+      sum += n * a + b * c + d * e;
+    });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ForUpToLargeCapture, std::function<void(int)>)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpToLargeCapture, FunctionPtr<void(int)>)->Arg(5);
+BENCHMARK_TEMPLATE(BM_ForUpToLargeCapture, FunctionRef<void(int)>)->Arg(5);
+
+}  // namespace
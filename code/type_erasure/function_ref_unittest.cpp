@@ -0,0 +1,76 @@
+#include "function_ref.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+static_assert(sizeof(FunctionRef<void(int)>) == 2 * sizeof(void*));
+static_assert(std::is_trivially_copyable_v<FunctionRef<void(int)>>);
+static_assert(!std::is_constructible_v<FunctionRef<void(int)>, int>);
+static_assert(!std::is_constructible_v<FunctionRef<int(std::string)>,
+                                       int (*)(int)>);
+
+int Twice(int n) { return 2 * n; }
+
+int Apply(FunctionRef<int(int)> f, int n) { return f(n); }
+
+struct Counter {
+  int calls = 0;
+  int operator()(int n) { return n + ++calls; }
+};
+
+TEST(FunctionRef, CallsFunctions) {
+  EXPECT_EQ(4, Apply(Twice, 2));
+  EXPECT_EQ(4, Apply(&Twice, 2));
+  int (*pointer)(int) = Twice;
+  FunctionRef<int(int)> f = pointer;
+  // the pointer was copied, not referenced
+  pointer = nullptr;
+  EXPECT_EQ(6, f(3));
+}
+
+TEST(FunctionRef, ReferencesFunctionObjects) {
+  Counter counter;
+  FunctionRef<int(int)> f = counter;
+  EXPECT_EQ(11, f(10));
+  EXPECT_EQ(12, f(10));
+  EXPECT_EQ(2, counter.calls);
+
+  const auto add = [base = 40](int n) { return base + n; };
+  EXPECT_EQ(42, Apply(add, 2));
+  EXPECT_EQ(42, Apply([](int n) { return n + 40; }, 2));
+
+  // the copy refers to the same object
+  FunctionRef<int(int)> copy = f;
+  copy(0);
+  EXPECT_EQ(3, counter.calls);
+}
+
+TEST(FunctionRef, ConvertsArgumentsAndResults) {
+  // the result is discarded
+  FunctionRef<void(int)> discard = Twice;
+  discard(1);
+
+  auto length = [](const std::string& s) { return s.size(); };
+  FunctionRef<long(const char*)> f = length;
+  EXPECT_EQ(5, f("hello"));
+
+  // move-only arguments are forwarded
+  auto take = [](std::unique_ptr<int> p) { return *p; };
+  FunctionRef<int(std::unique_ptr<int>)> g = take;
+  EXPECT_EQ(7, g(std::make_unique<int>(7)));
+
+  struct Point {
+    int x;
+    int Norm() const { return x; }
+  };
+  // referenced like any function object, so it must outlive the reference
+  auto norm = &Point::Norm;
+  FunctionRef<int(const Point&)> member = norm;
+  EXPECT_EQ(3, member(Point{3}));
+}
+
+}  // namespace
@@ -1,10 +1,74 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// The identity of a functor type, the address of a variable of its own.
+// Unlike a type's name it also tells closures of one scope apart.
+template <typename Functor>
+struct FunctorTypeTag {
+  static constexpr char kAnchor = 0;
+};
+
+template <typename Functor>
+inline constexpr const void* kFunctorTypeTag =
+    &FunctorTypeTag<Functor>::kAnchor;
+
+// Whether a function with parameters Params can be invoked with an index: a
+// single integral parameter other than bool
+template <typename... Params>
+inline constexpr bool kInvocableWithIndex = false;
+
+template <typename Param>
+inline constexpr bool kInvocableWithIndex<Param> =
+    std::is_integral_v<std::decay_t<Param>> &&
+    !std::is_same_v<std::decay_t<Param>, bool> &&
+    std::is_convertible_v<std::ptrdiff_t, Param>;
+
+// Whether index converts to Param without changing its value
+template <typename Param>
+constexpr bool IndexFits(std::ptrdiff_t index) noexcept {
+  using Limits = std::numeric_limits<std::decay_t<Param>>;
+  if (index < 0) {
+    return Limits::is_signed && static_cast<std::intmax_t>(index) >=
+                                    static_cast<std::intmax_t>(Limits::min());
+  }
+  return static_cast<std::uintmax_t>(index) <=
+         static_cast<std::uintmax_t>(Limits::max());
+}
+
+// The operations of a FunctorBridge that only signatures an index can be
+// passed to have, nothing for others.
+template <bool kIndexed>
+class FunctorRangeBridge {};
+
+template <>
+class FunctorRangeBridge<true> {
+ public:
+  // Invoke with each index of [first, last) in turn, discarding results, in
+  // one virtual call. The indices fit the parameter.
+  virtual void InvokeRange(std::ptrdiff_t first, std::ptrdiff_t last) const = 0;
+
+ protected:
+  ~FunctorRangeBridge() = default;
+};
+
 template <typename R, typename... Args>
-class FunctorBridge {
+class FunctorBridge
+    : public FunctorRangeBridge<kInvocableWithIndex<Args...>> {
  public:
   virtual ~FunctorBridge() {}
   virtual FunctorBridge* Clone() const = 0;
+  // Copy or move the bridge into the storage at buffer, which is large and
+  // aligned enough for it.
+  virtual FunctorBridge* CloneInto(void* buffer) const = 0;
+  virtual FunctorBridge* MoveInto(void* buffer) noexcept = 0;
   virtual R Invoke(Args... arg) const = 0;
   virtual bool Equals(const FunctorBridge* fb) const = 0;
-};
\ No newline at end of file
+  // The kFunctorTypeTag of the functor, equal for bridges of one type only.
+  // A call rather than a member, which would take room from the captures
+  // FunctionPtr stores inline.
+  virtual const void* TypeTag() const noexcept = 0;
+};
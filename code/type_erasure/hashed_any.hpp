@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "any.hpp"
+
+namespace cpp_idioms {
+
+// An any object with the hash of its contained object computed once, to key
+// unordered containers with values of different types.
+//
+//   std::unordered_map<HashedAny, Handler> handlers;
+//   handlers.emplace(42, OnCode);
+//   handlers.emplace(std::string("quit"), OnCommand);
+//   handlers.find(HashedAny(42));
+//
+// Keys of different types never compare equal, so 1 and 1L are different
+// keys. The contained type needs std::hash and operator==, types stored
+// from another any object are checked when it is hashed and compared.
+template <typename AnyType>
+class BasicHashedAny {
+ public:
+  // An empty key.
+  BasicHashedAny() noexcept = default;
+
+  // Construct from value, an any object or a value to construct one from.
+  // Throws NotHashable if the type of an any object has no std::hash.
+  template <typename ValueType, typename Tp = std::decay_t<ValueType>,
+            std::enable_if_t<!std::is_same_v<Tp, BasicHashedAny>, bool> = true>
+  BasicHashedAny(ValueType&& value)
+      : any_(std::forward<ValueType>(value)), hash_(any_.Hash()) {
+    if constexpr (!IsBasicAny<Tp>::value) {
+      static_assert(any_internal::Hashable<Tp>::value,
+                    "Keys need std::hash for their type");
+      static_assert(any_internal::EqualityComparable<Tp>::value,
+                    "Keys need operator== for their type");
+    }
+  }
+
+  const AnyType& Get() const noexcept { return any_; }
+
+  std::size_t Hash() const noexcept { return hash_; }
+
+  friend bool operator==(const BasicHashedAny& lhs, const BasicHashedAny& rhs) {
+    return lhs.hash_ == rhs.hash_ && lhs.any_.Equals(rhs.any_);
+  }
+
+  friend bool operator!=(const BasicHashedAny& lhs, const BasicHashedAny& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  // not handed out mutable, so the hash stays in sync with the object
+  AnyType any_;
+  std::size_t hash_ = 0;
+};
+
+using HashedAny = BasicHashedAny<Any>;
+
+}  // namespace cpp_idioms
+
+template <typename AnyType>
+struct std::hash<cpp_idioms::BasicHashedAny<AnyType>> {
+  std::size_t operator()(
+      const cpp_idioms::BasicHashedAny<AnyType>& key) const noexcept {
+    return key.Hash();
+  }
+};
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "hashed_any.hpp"
+
+namespace {
+
+using cpp_idioms::BasicAny;
+using cpp_idioms::BasicHashedAny;
+using cpp_idioms::HashedAny;
+
+using Variant = std::variant<int, std::string>;
+
+// Half ints and half short strings, the same for every key type.
+std::vector<Variant> MakeValues(std::size_t size) {
+  std::mt19937 random(42);
+  std::vector<Variant> values;
+  for (std::size_t i = 0; i < size; ++i) {
+    if (i % 2 == 0) {
+      values.emplace_back(static_cast<int>(random()));
+    } else {
+      values.emplace_back("key" + std::to_string(random() % 100000));
+    }
+  }
+  return values;
+}
+
+template <typename Key>
+Key MakeKey(const Variant& value) {
+  if constexpr (std::is_same_v<Key, Variant>) {
+    return value;
+  } else {
+    return std::visit([](const auto& alternative) { return Key(alternative); },
+                      value);
+  }
+}
+
+// Look up existing keys that are built before timing starts.
+template <typename Key>
+void BM_Lookup(benchmark::State& state) {
+  const std::vector<Variant> values = MakeValues(state.range(0));
+  std::unordered_map<Key, int> map;
+  std::vector<Key> keys;
+  for (const Variant& value : values) {
+    map.emplace(MakeKey<Key>(value), 1);
+    keys.push_back(MakeKey<Key>(value));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  for (auto _ : state) {
+    int found = 0;
+    for (const Key& key : keys) found += map.find(key)->second;
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_Lookup, Variant)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Lookup, HashedAny)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Lookup, BasicHashedAny<BasicAny<32, 8>>)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16);
+
+}  // namespace
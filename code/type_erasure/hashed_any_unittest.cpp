@@ -0,0 +1,79 @@
+#include "hashed_any.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+struct NoHash {
+  int value;
+  bool operator==(const NoHash& other) const { return value == other.value; }
+};
+
+struct NoEq {
+  int value;
+};
+
+TEST(Any, EqualsComparesTypeAndValue) {
+  EXPECT_TRUE(Any(1).Equals(Any(1)));
+  EXPECT_FALSE(Any(1).Equals(Any(2)));
+  EXPECT_FALSE(Any(1).Equals(Any(1L)));
+  EXPECT_TRUE(Any().Equals(Any()));
+  EXPECT_FALSE(Any().Equals(Any(1)));
+  // heap and inline objects, any objects of different capacities
+  std::string text(100, 'x');
+  using Any64 = BasicAny<64, 8>;
+  EXPECT_TRUE(Any(text).Equals(Any64(text)));
+  EXPECT_TRUE(Any(std::vector<int>{1, 2}).Equals(Any(std::vector<int>{1, 2})));
+
+  EXPECT_THROW(Any(NoEq{1}).Equals(Any(NoEq{1})), NotEqualityComparable);
+  // operator== of vector accepts any element type, but does not compile
+  EXPECT_THROW(Any(std::vector<NoEq>{}).Equals(Any(std::vector<NoEq>{})),
+               NotEqualityComparable);
+}
+
+TEST(Any, HashDependsOnTypeAndValue) {
+  EXPECT_EQ(Any(7).Hash(), Any(7).Hash());
+  EXPECT_NE(Any(7).Hash(), Any(7L).Hash());
+  using Any128 = BasicAny<128, 8>;
+  EXPECT_EQ(Any(std::string(100, 'x')).Hash(),
+            Any128(std::string(100, 'x')).Hash());
+  EXPECT_EQ(0u, Any().Hash());
+  EXPECT_THROW(Any(NoHash{1}).Hash(), NotHashable);
+}
+
+TEST(HashedAny, KeysUnorderedMap) {
+  std::unordered_map<HashedAny, int> map;
+  map.emplace(1, 10);
+  map.emplace(1L, 11);
+  map.emplace(std::string("one"), 12);
+  map.emplace(HashedAny(), 13);
+  EXPECT_EQ(4u, map.size());
+  EXPECT_FALSE(map.emplace(1, 0).second);
+
+  EXPECT_EQ(10, map.at(1));
+  EXPECT_EQ(11, map.at(1L));
+  EXPECT_EQ(12, map.at(std::string("one")));
+  EXPECT_EQ(13, map.at(HashedAny()));
+  EXPECT_EQ(map.end(), map.find(2));
+  EXPECT_EQ(map.end(), map.find(1u));
+}
+
+TEST(HashedAny, CopiesEqualTheOriginal) {
+  HashedAny key = std::string("key");
+  HashedAny copy = key;
+  EXPECT_EQ(key, copy);
+  EXPECT_EQ(key.Hash(), copy.Hash());
+  EXPECT_EQ("key", AnyCast<const std::string&>(copy.Get()));
+  EXPECT_NE(key, HashedAny(std::string("other")));
+
+  // types only known at run time are checked when the key is made
+  EXPECT_THROW(HashedAny(Any(NoHash{1})), NotHashable);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
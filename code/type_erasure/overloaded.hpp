@@ -0,0 +1,16 @@
+#pragma once
+
+namespace cpp_idioms {
+
+// Combine lambdas into one visitor with an overload for each of them.
+//
+//   Overloaded{[](int i) { ... }, [](const std::string& s) { ... }}
+template <typename... Fs>
+struct Overloaded : Fs... {
+  using Fs::operator()...;
+};
+
+template <typename... Fs>
+Overloaded(Fs...) -> Overloaded<Fs...>;
+
+}  // namespace cpp_idioms
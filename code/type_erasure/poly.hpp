@@ -0,0 +1,337 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cpp_idioms {
+
+// The signatures of an interface, in table order, e.g.
+// PolySignatures<void(std::ostream&) const, void(double)>. Const signatures
+// can be called on a const Poly.
+template <typename... Signatures>
+struct PolySignatures {};
+
+// What implements each signature for one type, in the same order: member
+// function pointers, or pointers to functions taking the object first.
+template <auto... Members>
+struct PolyMembers {};
+
+namespace poly_internal {
+
+template <typename Signature>
+struct Thunk;
+
+template <typename R, typename... Args>
+struct Thunk<R(Args...)> {
+  using Type = R (*)(void* storage, Args... args);
+};
+
+template <typename R, typename... Args>
+struct Thunk<R(Args...) const> {
+  using Type = R (*)(const void* storage, Args... args);
+};
+
+// The operations of one type behind a Poly, shared by all Polys holding it.
+template <typename... Signatures>
+struct Table {
+  void (*destroy)(void* storage) noexcept;
+  void (*copy)(const void* from, void* to);
+  // move and destroy the object at from
+  void (*move)(void* from, void* to) noexcept;
+  bool stored_inline;
+  std::tuple<typename Thunk<Signatures>::Type...> members;
+};
+
+// How a T lives in the buffer of a Poly: in place, or allocated with a
+// pointer to it in the buffer.
+template <typename T, bool Inline>
+struct Storage {
+  static T& Get(void* storage) noexcept {
+    if constexpr (Inline) {
+      return *std::launder(static_cast<T*>(storage));
+    } else {
+      return **static_cast<T**>(storage);
+    }
+  }
+
+  static const T& Get(const void* storage) noexcept {
+    return Get(const_cast<void*>(storage));
+  }
+
+  template <typename... CtorArgs>
+  static void Create(void* storage, CtorArgs&&... args) {
+    if constexpr (Inline) {
+      ::new (storage) T(std::forward<CtorArgs>(args)...);
+    } else {
+      *static_cast<T**>(storage) = new T(std::forward<CtorArgs>(args)...);
+    }
+  }
+
+  static void Destroy(void* storage) noexcept {
+    if constexpr (Inline) {
+      Get(storage).~T();
+    } else {
+      delete *static_cast<T**>(storage);
+    }
+  }
+
+  static void Copy(const void* from, void* to) { Create(to, Get(from)); }
+
+  static void Move(void* from, void* to) noexcept {
+    if constexpr (Inline) {
+      Create(to, std::move(Get(from)));
+      Destroy(from);
+    } else {
+      *static_cast<T**>(to) = *static_cast<T**>(from);
+    }
+  }
+};
+
+template <typename Signature, auto Member, typename T, bool Inline>
+struct MemberThunk;
+
+template <typename R, typename... Args, auto Member, typename T, bool Inline>
+struct MemberThunk<R(Args...), Member, T, Inline> {
+  static R Call(void* storage, Args... args) {
+    return static_cast<R>(std::invoke(Member, Storage<T, Inline>::Get(storage),
+                                      std::forward<Args>(args)...));
+  }
+};
+
+template <typename R, typename... Args, auto Member, typename T, bool Inline>
+struct MemberThunk<R(Args...) const, Member, T, Inline> {
+  static R Call(const void* storage, Args... args) {
+    return static_cast<R>(std::invoke(Member, Storage<T, Inline>::Get(storage),
+                                      std::forward<Args>(args)...));
+  }
+};
+
+template <typename Signatures, typename Members, typename T, bool Inline>
+struct Model;
+
+template <typename... Signatures, auto... Members, typename T, bool Inline>
+struct Model<PolySignatures<Signatures...>, PolyMembers<Members...>, T,
+             Inline> {
+  static_assert(sizeof...(Signatures) == sizeof...(Members),
+                "one member per signature");
+
+  static constexpr Table<Signatures...> kTable = {
+      &Storage<T, Inline>::Destroy,
+      &Storage<T, Inline>::Copy,
+      &Storage<T, Inline>::Move,
+      Inline,
+      {&MemberThunk<Signatures, Members, T, Inline>::Call...}};
+};
+
+// Whether Member can implement Signature for a T
+template <typename Signature, auto Member, typename T>
+inline constexpr bool kImplements = false;
+
+template <typename R, typename... Args, auto Member, typename T>
+inline constexpr bool kImplements<R(Args...), Member, T> =
+    std::is_invocable_r_v<R, decltype(Member), T&, Args...>;
+
+template <typename R, typename... Args, auto Member, typename T>
+inline constexpr bool kImplements<R(Args...) const, Member, T> =
+    std::is_invocable_r_v<R, decltype(Member), const T&, Args...>;
+
+template <typename Signatures, typename Members, typename T,
+          typename = void>
+struct ImplementsAll : std::false_type {};
+
+template <typename... Signatures, auto... Members, typename T>
+struct ImplementsAll<PolySignatures<Signatures...>, PolyMembers<Members...>,
+                     T,
+                     std::enable_if_t<sizeof...(Signatures) ==
+                                      sizeof...(Members)>>
+    : std::bool_constant<(kImplements<Signatures, Members, T> && ...)> {};
+
+// Whether a Poly of Interface can hold a T: T is copyable and the members
+// Interface names for it implement the signatures.
+template <typename Interface, typename T, typename = void>
+struct Models : std::false_type {};
+
+template <typename Interface, typename T>
+struct Models<Interface, T,
+              std::void_t<typename Interface::template Members<T>>>
+    : std::bool_constant<
+          std::is_copy_constructible_v<T> &&
+          ImplementsAll<typename Interface::Signatures,
+                        typename Interface::template Members<T>, T>::value> {
+};
+
+}  // namespace poly_internal
+
+// The default inline capacity of Poly in bytes.
+inline constexpr std::size_t kPolyCapacity = 3 * sizeof(void*);
+
+// primary template
+template <typename Signatures, std::size_t Capacity>
+class PolyBase;
+
+// The storage of a Poly, and the base of the Methods of its interface.
+template <typename... Signatures, std::size_t Capacity>
+class PolyBase<PolySignatures<Signatures...>, Capacity> {
+ public:
+  explicit operator bool() const noexcept { return table_ != nullptr; }
+
+  // Whether the object lives in the Poly itself
+  bool IsStoredInline() const noexcept {
+    return table_ && table_->stored_inline;
+  }
+
+ protected:
+  using Table = poly_internal::Table<Signatures...>;
+
+  PolyBase() noexcept : table_{nullptr} {}
+
+  PolyBase(const PolyBase& other) : table_{nullptr} {
+    if (other.table_) {
+      other.table_->copy(other.buffer_, buffer_);
+      table_ = other.table_;
+    }
+  }
+
+  PolyBase(PolyBase&& other) noexcept : table_{nullptr} { MoveFrom(other); }
+
+  PolyBase& operator=(const PolyBase& other) {
+    PolyBase temp(other);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  PolyBase& operator=(PolyBase&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~PolyBase() { Reset(); }
+
+  // Call the implementation of the I-th signature. The Poly must not be
+  // empty.
+  template <std::size_t I, typename... Args>
+  decltype(auto) Call(Args&&... args) const {
+    return std::get<I>(table_->members)(static_cast<const void*>(buffer_),
+                                        std::forward<Args>(args)...);
+  }
+
+  template <std::size_t I, typename... Args>
+  decltype(auto) Call(Args&&... args) {
+    return std::get<I>(table_->members)(static_cast<void*>(buffer_),
+                                        std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename Members, bool Inline, typename... CtorArgs>
+  void Emplace(CtorArgs&&... args) {
+    static_assert(std::is_copy_constructible_v<T>, "Poly is copyable");
+    using Model =
+        poly_internal::Model<PolySignatures<Signatures...>, Members, T, Inline>;
+    Reset();
+    poly_internal::Storage<T, Inline>::Create(buffer_,
+                                              std::forward<CtorArgs>(args)...);
+    table_ = &Model::kTable;
+  }
+
+  void Reset() noexcept {
+    if (table_) {
+      table_->destroy(buffer_);
+      table_ = nullptr;
+    }
+  }
+
+ private:
+  // Take the object of other, which is left empty
+  void MoveFrom(PolyBase& other) noexcept {
+    if (other.table_) {
+      other.table_->move(other.buffer_, buffer_);
+      table_ = std::exchange(other.table_, nullptr);
+    }
+  }
+
+  const Table* table_;
+  // The object, or a pointer to it if it does not fit
+  alignas(void*) unsigned char buffer_[Capacity < sizeof(void*)
+                                           ? sizeof(void*)
+                                           : Capacity];
+};
+
+// A value of any type that has the member functions Interface describes,
+// e.g. shapes without a Shape base class:
+//
+//   struct ShapeInterface {
+//     using Signatures = PolySignatures<double() const,
+//                                       void(std::ostream&) const>;
+//     template <typename T>
+//     using Members = PolyMembers<&T::Area, &T::Draw>;
+//
+//     template <typename Base>
+//     struct Methods : Base {
+//       double Area() const { return this->template Call<0>(); }
+//       void Draw(std::ostream& os) const { this->template Call<1>(os); }
+//     };
+//   };
+//   using Shape = Poly<ShapeInterface>;
+//
+//   std::vector<Shape> shapes = {Circle{1.0}, Rectangle{2.0, 3.0}};
+//   for (const Shape& shape : shapes) shape.Draw(std::cout);
+//
+// This is external polymorphism with the table of FunctionPtr moved out of
+// the object, as in StaticFunctionPtr: each type gets one static table of
+// function pointers, and the Poly holds a pointer to it next to the object.
+// Objects that fit into Capacity bytes and are nothrow movable are stored
+// inline, others are allocated. Polys are values, copying one copies the
+// object.
+template <typename Interface, std::size_t Capacity = kPolyCapacity>
+class Poly : public Interface::template Methods<
+                 PolyBase<typename Interface::Signatures, Capacity>> {
+  using Base = typename Interface::template Methods<
+      PolyBase<typename Interface::Signatures, Capacity>>;
+
+ public:
+  // Whether an object of type T is stored without allocation
+  template <typename T>
+  static constexpr bool kFitsInline = sizeof(T) <= Capacity &&
+                                      alignof(T) <= alignof(void*) &&
+                                      std::is_nothrow_move_constructible_v<T>;
+
+  Poly() noexcept = default;
+
+  // Whether a Poly can hold a T, which converts to it
+  template <typename T>
+  static constexpr bool kHolds = poly_internal::Models<Interface, T>::value;
+
+  template <typename T,
+            std::enable_if_t<!std::is_same_v<std::decay_t<T>, Poly> &&
+                                 kHolds<std::decay_t<T>>,
+                             bool> = true>
+  Poly(T&& value) {
+    using Type = std::decay_t<T>;
+    this->template Emplace<Type, typename Interface::template Members<Type>,
+                           kFitsInline<Type>>(std::forward<T>(value));
+  }
+
+  template <typename T,
+            std::enable_if_t<!std::is_same_v<std::decay_t<T>, Poly> &&
+                                 kHolds<std::decay_t<T>>,
+                             bool> = true>
+  Poly& operator=(T&& value) {
+    Poly temp(std::forward<T>(value));
+    *this = std::move(temp);
+    return *this;
+  }
+
+  friend void swap(Poly& p1, Poly& p2) noexcept {
+    Poly temp(std::move(p1));
+    p1 = std::move(p2);
+    p2 = std::move(temp);
+  }
+};
+
+}  // namespace cpp_idioms
@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "poly.hpp"
+
+namespace {
+
+using cpp_idioms::Poly;
+using cpp_idioms::PolyMembers;
+using cpp_idioms::PolySignatures;
+
+// The virtual class hierarchy Poly replaces.
+class ShapeBase {
+ public:
+  virtual ~ShapeBase() {}
+  virtual void Draw(std::ostream& os) const = 0;
+  virtual std::string Serialize() const = 0;
+  virtual double Size() const = 0;
+};
+
+class VirtualCircle : public ShapeBase {
+ public:
+  explicit VirtualCircle(double r) : r_(r) {}
+  void Draw(std::ostream& os) const override { os << "()"; }
+  std::string Serialize() const override { return "circle"; }
+  double Size() const override { return 3.0 * r_ * r_; }
+
+ private:
+  double r_;
+};
+
+class VirtualRectangle : public ShapeBase {
+ public:
+  VirtualRectangle(double w, double h) : w_(w), h_(h) {}
+  void Draw(std::ostream& os) const override { os << "[]"; }
+  std::string Serialize() const override { return "rectangle"; }
+  double Size() const override { return w_ * h_; }
+
+ private:
+  double w_;
+  double h_;
+};
+
+// The same shapes without a base class.
+struct Circle {
+  void Draw(std::ostream& os) const { os << "()"; }
+  std::string Serialize() const { return "circle"; }
+  double Size() const { return 3.0 * r * r; }
+
+  double r;
+};
+
+struct Rectangle {
+  void Draw(std::ostream& os) const { os << "[]"; }
+  std::string Serialize() const { return "rectangle"; }
+  double Size() const { return w * h; }
+
+  double w;
+  double h;
+};
+
+struct ShapeInterface {
+  using Signatures = PolySignatures<void(std::ostream&) const,
+                                    std::string() const, double() const>;
+  template <typename T>
+  using Members = PolyMembers<&T::Draw, &T::Serialize, &T::Size>;
+
+  template <typename Base>
+  struct Methods : Base {
+    void Draw(std::ostream& os) const { this->template Call<0>(os); }
+    std::string Serialize() const { return this->template Call<1>(); }
+    double Size() const { return this->template Call<2>(); }
+  };
+};
+
+using Shape = Poly<ShapeInterface>;
+
+std::vector<std::unique_ptr<ShapeBase>> MakeVirtualShapes(int n) {
+  std::vector<std::unique_ptr<ShapeBase>> shapes;
+  shapes.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    if (i % 2) {
+      shapes.push_back(std::make_unique<VirtualCircle>(i));
+    } else {
+      shapes.push_back(std::make_unique<VirtualRectangle>(i, 2.0));
+    }
+  }
+  return shapes;
+}
+
+std::vector<Shape> MakePolyShapes(int n) {
+  std::vector<Shape> shapes;
+  shapes.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    if (i % 2) {
+      shapes.push_back(Circle{static_cast<double>(i)});
+    } else {
+      shapes.push_back(Rectangle{static_cast<double>(i), 2.0});
+    }
+  }
+  return shapes;
+}
+
+void BM_BuildVirtual(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MakeVirtualShapes(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildVirtual)->Range(1 << 10, 1 << 16);
+
+void BM_BuildPoly(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MakePolyShapes(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildPoly)->Range(1 << 10, 1 << 16);
+
+void BM_SizeVirtual(benchmark::State& state) {
+  const auto shapes = MakeVirtualShapes(state.range(0));
+  for (auto _ : state) {
+    double size = 0;
+    for (const auto& shape : shapes) size += shape->Size();
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SizeVirtual)->Range(1 << 10, 1 << 16);
+
+void BM_SizePoly(benchmark::State& state) {
+  const auto shapes = MakePolyShapes(state.range(0));
+  for (auto _ : state) {
+    double size = 0;
+    for (const Shape& shape : shapes) size += shape.Size();
+    benchmark::DoNotOptimize(size);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SizePoly)->Range(1 << 10, 1 << 16);
+
+}  // namespace
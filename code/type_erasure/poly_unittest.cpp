@@ -0,0 +1,187 @@
+#include "poly.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+struct ShapeInterface {
+  using Signatures = PolySignatures<void(std::ostream&) const,
+                                    std::string() const, double() const,
+                                    void(double)>;
+  template <typename T>
+  using Members = PolyMembers<&T::Draw, &T::Serialize, &T::Size, &T::Scale>;
+
+  template <typename Base>
+  struct Methods : Base {
+    void Draw(std::ostream& os) const { this->template Call<0>(os); }
+    std::string Serialize() const { return this->template Call<1>(); }
+    double Size() const { return this->template Call<2>(); }
+    void Scale(double factor) { this->template Call<3>(factor); }
+  };
+};
+
+using Shape = Poly<ShapeInterface>;
+
+struct Circle {
+  void Draw(std::ostream& os) const { os << "()"; }
+  std::string Serialize() const { return "circle " + std::to_string(r); }
+  // converted to the double of the signature
+  float Size() const { return 3.0f * r * r; }
+  void Scale(double factor) { r *= factor; }
+
+  float r;
+};
+
+struct Rectangle {
+  void Draw(std::ostream& os) const { os << "[]"; }
+  std::string Serialize() const { return "rectangle"; }
+  double Size() const { return w * h; }
+  void Scale(double factor) {
+    w *= factor;
+    h *= factor;
+  }
+
+  double w;
+  double h;
+};
+
+// too large to be stored inline, and owns a buffer
+struct Polygon {
+  void Draw(std::ostream& os) const { os << "<>"; }
+  std::string Serialize() const { return "polygon " + *name; }
+  double Size() const { return points[0] * points.size(); }
+  void Scale(double factor) { points[0] *= factor; }
+
+  std::array<double, 8> points;
+  std::shared_ptr<std::string> name;
+};
+
+// lacks Scale()
+struct Label {
+  void Draw(std::ostream& os) const { os << "label"; }
+  std::string Serialize() const { return "label"; }
+  double Size() const { return 0; }
+};
+
+// Size() returns nothing a double converts from
+struct Blob {
+  void Draw(std::ostream& os) const {}
+  std::string Serialize() const { return "blob"; }
+  std::string Size() const { return "big"; }
+  void Scale(double) {}
+};
+
+// not copyable
+struct MovableOnly : Rectangle {
+  MovableOnly(MovableOnly&&) = default;
+};
+
+TEST(Poly, ConvertsFromTypesThatHaveTheMembersOnly) {
+  static_assert(std::is_convertible_v<Circle, Shape>);
+  static_assert(std::is_assignable_v<Shape&, const Rectangle&>);
+  static_assert(!std::is_convertible_v<int, Shape>);
+  static_assert(!std::is_convertible_v<Label, Shape>);
+  static_assert(!std::is_convertible_v<Blob, Shape>);
+  static_assert(!std::is_convertible_v<MovableOnly, Shape>);
+  static_assert(!std::is_assignable_v<Shape&, Label>);
+  static_assert(!Shape::kHolds<Label>);
+}
+
+TEST(Poly, CallsTheMembersOfAnyType) {
+  static_assert(Shape::kFitsInline<Circle>);
+  static_assert(Shape::kFitsInline<Rectangle>);
+  static_assert(!Shape::kFitsInline<Polygon>);
+
+  std::vector<Shape> shapes;
+  shapes.push_back(Circle{1.0f});
+  shapes.push_back(Rectangle{2.0, 3.0});
+  shapes.push_back(
+      Polygon{{1.0}, std::make_shared<std::string>("octagon")});
+  EXPECT_TRUE(shapes[0].IsStoredInline());
+  EXPECT_TRUE(shapes[1].IsStoredInline());
+  EXPECT_FALSE(shapes[2].IsStoredInline());
+
+  std::ostringstream os;
+  double size = 0;
+  for (const Shape& shape : shapes) {
+    shape.Draw(os);
+    size += shape.Size();
+  }
+  EXPECT_EQ("()[]<>", os.str());
+  EXPECT_EQ(3.0 + 6.0 + 8.0, size);
+  EXPECT_EQ("polygon octagon", shapes[2].Serialize());
+
+  for (Shape& shape : shapes) shape.Scale(2.0);
+  EXPECT_EQ(12.0, shapes[0].Size());
+  EXPECT_EQ(24.0, shapes[1].Size());
+  EXPECT_EQ(16.0, shapes[2].Size());
+}
+
+TEST(Poly, IsAValue) {
+  Shape empty;
+  EXPECT_FALSE(empty);
+  EXPECT_FALSE(empty.IsStoredInline());
+
+  Shape circle = Circle{1.0f};
+  Shape copy = circle;
+  copy.Scale(2.0);
+  EXPECT_EQ(3.0, circle.Size());
+  EXPECT_EQ(12.0, copy.Size());
+
+  auto name = std::make_shared<std::string>("square");
+  Shape polygon = Polygon{{1.0}, name};
+  Shape other = polygon;
+  EXPECT_EQ(3, name.use_count());
+  other.Scale(3.0);
+  EXPECT_EQ(8.0, polygon.Size());
+  EXPECT_EQ(24.0, other.Size());
+
+  // moving leaves the source empty
+  Shape moved = std::move(polygon);
+  EXPECT_FALSE(polygon);
+  EXPECT_EQ(8.0, moved.Size());
+  EXPECT_EQ(3, name.use_count());
+
+  swap(circle, moved);
+  EXPECT_EQ("polygon square", circle.Serialize());
+  EXPECT_EQ("circle 1.000000", moved.Serialize());
+
+  circle = Rectangle{1.0, 1.0};
+  EXPECT_EQ(2, name.use_count());
+  other = circle;
+  EXPECT_EQ(1, name.use_count());
+  EXPECT_EQ("rectangle", other.Serialize());
+}
+
+struct Legacy {
+  int area;
+};
+
+int LegacyArea(const Legacy& legacy) { return legacy.area; }
+
+struct AreaInterface {
+  using Signatures = PolySignatures<double() const>;
+  template <typename T>
+  using Members = PolyMembers<&LegacyArea>;
+
+  template <typename Base>
+  struct Methods : Base {
+    double Area() const { return this->template Call<0>(); }
+  };
+};
+
+TEST(Poly, AdaptsFreeFunctions) {
+  Poly<AreaInterface> area = Legacy{5};
+  EXPECT_EQ(5.0, area.Area());
+}
+
+}  // namespace
+}  // namespace cpp_idioms
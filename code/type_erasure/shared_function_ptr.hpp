@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "functor_bridge.hpp"
+#include "try_equals.hpp"
+
+// Reference count policies of SharedFunctionPtr. Counts start at 1, the
+// reference of the creator.
+
+// For SharedFunctionPtrs that are copied and destroyed by several threads.
+class AtomicRefCount {
+ public:
+  void Increment() noexcept { count_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Whether the last reference is gone
+  bool Decrement() noexcept {
+    return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  std::size_t Get() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::size_t> count_{1};
+};
+
+// For SharedFunctionPtrs that stay on one thread.
+class NonAtomicRefCount {
+ public:
+  void Increment() noexcept { ++count_; }
+
+  // Whether the last reference is gone
+  bool Decrement() noexcept { return --count_ == 0; }
+
+  std::size_t Get() const noexcept { return count_; }
+
+ private:
+  std::size_t count_ = 1;
+};
+
+// The bridge of SharedFunctionPtr, immutable after construction and owned by
+// all SharedFunctionPtrs that point to it.
+template <typename RefCount, typename R, typename... Args>
+class SharedFunctorBridge {
+ public:
+  explicit SharedFunctorBridge(const void* type_tag) : type_tag_(type_tag) {}
+  virtual ~SharedFunctorBridge() {}
+  virtual R Invoke(Args... args) const = 0;
+  virtual bool Equals(const SharedFunctorBridge* fb) const = 0;
+
+  // The kFunctorTypeTag of the functor
+  const void* TypeTag() const noexcept { return type_tag_; }
+
+  void AddRef() const noexcept { ref_count_.Increment(); }
+
+  void Release() const noexcept {
+    if (ref_count_.Decrement()) delete this;
+  }
+
+  std::size_t UseCount() const noexcept { return ref_count_.Get(); }
+
+ private:
+  const void* type_tag_;
+  mutable RefCount ref_count_;
+};
+
+template <typename Functor, typename RefCount, typename R, typename... Args>
+class SpecificSharedFunctorBridge
+    : public SharedFunctorBridge<RefCount, R, Args...> {
+  using Base = SharedFunctorBridge<RefCount, R, Args...>;
+
+ public:
+  template <typename FunctorFwd>
+  SpecificSharedFunctorBridge(FunctorFwd&& functor)
+      : Base(kFunctorTypeTag<Functor>),
+        functor_(std::forward<FunctorFwd>(functor)) {}
+
+  virtual R Invoke(Args... args) const override {
+    return functor_(std::forward<Args>(args)...);
+  }
+
+  virtual bool Equals(const Base* fb) const override {
+    if (fb->TypeTag() == kFunctorTypeTag<Functor>) {
+      auto spec_fb = static_cast<const SpecificSharedFunctorBridge*>(fb);
+      return TryEquals<Functor>::Equals(functor_, spec_fb->functor_);
+    }
+    // functors with different types are never equal:
+    return false;
+  }
+
+ private:
+  const Functor functor_;
+};
+
+// primary template
+template <typename Signature, typename RefCount = AtomicRefCount>
+class SharedFunctionPtr;
+
+// A FunctionPtr whose copies share one functor instead of cloning it, for
+// large closures that are copied into many places, e.g. a callback fanned out
+// to hundreds of queues. Calls cannot modify the functor, so sharing it is
+// invisible to callers; assigning to a copy rebinds that copy only.
+//
+// The functor is allocated once with an intrusive reference count, copying
+// costs an increment. RefCount is AtomicRefCount by default, copies that
+// never leave one thread can use NonAtomicRefCount instead.
+template <typename R, typename... Args, typename RefCount>
+class SharedFunctionPtr<R(Args...), RefCount> {
+  using Bridge = SharedFunctorBridge<RefCount, R, Args...>;
+
+ public:
+  SharedFunctionPtr() noexcept : bridge_{nullptr} {}
+
+  SharedFunctionPtr(const SharedFunctionPtr& other) noexcept
+      : bridge_{other.bridge_} {
+    if (bridge_) bridge_->AddRef();
+  }
+
+  SharedFunctionPtr(SharedFunctionPtr& other) noexcept
+      : SharedFunctionPtr(static_cast<SharedFunctionPtr const&>(other)) {}
+  SharedFunctionPtr(SharedFunctionPtr&& other) noexcept
+      : bridge_{std::exchange(other.bridge_, nullptr)} {}
+
+  template <typename F>
+  SharedFunctionPtr(F&& f)
+      : bridge_{new SpecificSharedFunctorBridge<std::decay_t<F>, RefCount, R,
+                                                Args...>(std::forward<F>(f))} {
+  }
+
+  // assignment operators:
+  SharedFunctionPtr& operator=(const SharedFunctionPtr& other) noexcept {
+    SharedFunctionPtr temp(other);
+    swap(*this, temp);
+    return *this;
+  }
+
+  SharedFunctionPtr& operator=(SharedFunctionPtr&& other) noexcept {
+    SharedFunctionPtr temp(std::move(other));
+    swap(*this, temp);
+    return *this;
+  }
+
+  // construction and assignment from arbitrary function objects:
+  template <typename F>
+  SharedFunctionPtr& operator=(F&& f) {
+    SharedFunctionPtr temp(std::forward<F>(f));
+    swap(*this, temp);
+    return *this;
+  }
+
+  ~SharedFunctionPtr() {
+    if (bridge_) bridge_->Release();
+  }
+
+  friend bool operator==(const SharedFunctionPtr& f1,
+                         const SharedFunctionPtr& f2) {
+    if (f1.bridge_ == f2.bridge_) {
+      return true;
+    }
+    if (!f1 || !f2) {
+      return false;
+    }
+    // functors with different types are never equal:
+    if (f1.bridge_->TypeTag() != f2.bridge_->TypeTag()) {
+      return false;
+    }
+    return f1.bridge_->Equals(f2.bridge_);
+  }
+  friend bool operator!=(const SharedFunctionPtr& f1,
+                         const SharedFunctionPtr& f2) {
+    return !(f1 == f2);
+  }
+
+  friend void swap(SharedFunctionPtr& fp1, SharedFunctionPtr& fp2) noexcept {
+    std::swap(fp1.bridge_, fp2.bridge_);
+  }
+
+  explicit operator bool() const noexcept { return bridge_ != nullptr; }
+
+  // The number of SharedFunctionPtrs sharing the functor, 0 if empty
+  std::size_t UseCount() const noexcept {
+    return bridge_ ? bridge_->UseCount() : 0;
+  }
+
+  // invocation
+  R operator()(Args... args) const {
+    return bridge_->Invoke(std::forward<Args>(args)...);
+  }
+
+ private:
+  const Bridge* bridge_;
+};
+
+// A SharedFunctionPtr for one thread, whose copies need no atomic operations
+template <typename Signature>
+using LocalSharedFunctionPtr = SharedFunctionPtr<Signature, NonAtomicRefCount>;
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "function_ptr.hpp"
+#include "shared_function_ptr.hpp"
+
+namespace {
+
+// A closure too large for inline storage, as a message routed to many
+// subscribers.
+auto MakeClosure() {
+  std::string topic(64, 't');
+  std::array<long, 16> payload{};
+  return [topic, payload](int n) {
+    return static_cast<long>(topic.size()) + payload[n % 16];
+  };
+}
+
+// Copy one closure into every queue, call and drop them.
+template <typename Function>
+void BM_FanOut(benchmark::State& state) {
+  const Function f = MakeClosure();
+  std::vector<Function> queues(state.range(0));
+  long sum = 0;
+  for (auto _ : state) {
+    for (Function& queue : queues) queue = f;
+    for (const Function& queue : queues) sum += queue(1);
+    for (Function& queue : queues) queue = Function();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_FanOut, std::function<long(int)>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_FanOut, FunctionPtr<long(int)>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_FanOut, SharedFunctionPtr<long(int)>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_FanOut, LocalSharedFunctionPtr<long(int)>)->Arg(256);
+
+// Copies of one shared closure on several threads at once, the reference
+// count is contended.
+template <typename Function>
+void BM_CopyOnThreads(benchmark::State& state) {
+  static const Function f = MakeClosure();
+  for (auto _ : state) {
+    Function copy = f;
+    benchmark::DoNotOptimize(&copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_CopyOnThreads, FunctionPtr<long(int)>)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_CopyOnThreads, SharedFunctionPtr<long(int)>)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+
+}  // namespace
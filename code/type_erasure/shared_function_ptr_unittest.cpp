@@ -0,0 +1,104 @@
+#include "shared_function_ptr.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int Twice(int n) { return 2 * n; }
+
+// Counts live instances and copies.
+struct Counted {
+  static int live;
+  static int copies;
+  Counted() { ++live; }
+  Counted(const Counted&) {
+    ++live;
+    ++copies;
+  }
+  Counted(Counted&&) noexcept { ++live; }
+  ~Counted() { --live; }
+  int operator()(int n) const { return n + 1; }
+};
+
+int Counted::live = 0;
+int Counted::copies = 0;
+
+TEST(SharedFunctionPtr, CopiesShareTheFunctor) {
+  {
+    SharedFunctionPtr<int(int)> f = Counted{};
+    Counted::copies = 0;
+    std::vector<SharedFunctionPtr<int(int)>> queues(100, f);
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_EQ(1, Counted::live);
+    EXPECT_EQ(101u, f.UseCount());
+    EXPECT_EQ(2, queues[7](1));
+
+    // rebinding a copy leaves the others alone
+    queues[0] = Twice;
+    EXPECT_EQ(4, queues[0](2));
+    EXPECT_EQ(3, queues[1](2));
+    EXPECT_EQ(100u, f.UseCount());
+
+    SharedFunctionPtr<int(int)> moved = std::move(f);
+    EXPECT_FALSE(f);
+    EXPECT_EQ(0u, f.UseCount());
+    EXPECT_EQ(100u, moved.UseCount());
+    queues.clear();
+    EXPECT_EQ(1u, moved.UseCount());
+    EXPECT_EQ(1, Counted::live);
+  }
+  EXPECT_EQ(0, Counted::live);
+}
+
+TEST(SharedFunctionPtr, ComparesFunctors) {
+  SharedFunctionPtr<int(int)> empty;
+  SharedFunctionPtr<int(int)> f = Twice;
+  SharedFunctionPtr<int(int)> g = Twice;
+  SharedFunctionPtr<int(int)> copy = f;
+  EXPECT_TRUE(empty == SharedFunctionPtr<int(int)>());
+  EXPECT_TRUE(f == copy);
+  EXPECT_TRUE(f == g);
+  EXPECT_TRUE(f != empty);
+
+  // functors that cannot be compared are equal to their copies only
+  SharedFunctionPtr<int(int)> counted = Counted{};
+  SharedFunctionPtr<int(int)> counted_copy = counted;
+  EXPECT_TRUE(counted == counted_copy);
+  EXPECT_THROW((void)(counted == SharedFunctionPtr<int(int)>(Counted{})),
+               NotEqualityComparable);
+}
+
+TEST(SharedFunctionPtr, LocalPolicy) {
+  std::string prefix(100, '>');
+  LocalSharedFunctionPtr<std::string(const std::string&)> f =
+      [prefix](const std::string& s) { return prefix + s; };
+  LocalSharedFunctionPtr<std::string(const std::string&)> copy = f;
+  EXPECT_EQ(2u, f.UseCount());
+  EXPECT_EQ(prefix + "x", copy("x"));
+}
+
+// Copies made and dropped on many threads at once.
+TEST(SharedFunctionPtr, CopiesOnManyThreads) {
+  Counted::live = 0;
+  {
+    SharedFunctionPtr<int(int)> f = Counted{};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([f] {
+        for (int j = 0; j < 10000; ++j) {
+          SharedFunctionPtr<int(int)> copy = f;
+          EXPECT_EQ(2, copy(1));
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    EXPECT_EQ(1u, f.UseCount());
+  }
+  EXPECT_EQ(0, Counted::live);
+}
+
+}  // namespace
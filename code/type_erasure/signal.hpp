@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "function_ptr.hpp"
+#include "utils/epoch.hpp"
+
+namespace cpp_idioms {
+
+// primary template
+template <typename Signature>
+class Signal;
+
+// A list of subscribers that many threads emit to while others connect and
+// disconnect, e.g. event fan-out.
+//
+//   Signal<void(const Event&)> on_event;
+//   on_event.Connect(Log);
+//   on_event.Connect([this](const Event& event) { Handle(event); });
+//   on_event.Emit(event);
+//   on_event.Disconnect(Log);
+//
+// Emit() is lock-free: it calls the subscribers of an immutable snapshot of
+// the list, so it neither waits for writers nor for other emitters. Connect()
+// and Disconnect() publish a new snapshot of subscriber pointers, the
+// subscribers themselves are never copied. Snapshots and subscribers that
+// were replaced are destroyed through epoch-based reclamation once no Emit()
+// can see them anymore. Writers are serialized on a mutex that Emit() never
+// touches.
+//
+// A subscriber may be called by an Emit() that started before it was
+// disconnected, and subscribers may connect and disconnect from within an
+// Emit(), which then keeps calling its snapshot.
+template <typename... Args>
+class Signal<void(Args...)> {
+ public:
+  using Function = FunctionPtr<void(Args...)>;
+
+  Signal() : subscribers_(new List()) {}
+
+  Signal(const Signal&) = delete;
+  Signal& operator=(const Signal&) = delete;
+
+  ~Signal() {
+    const List* list = subscribers_.load(std::memory_order_relaxed);
+    for (const Function* function : *list) delete function;
+    delete list;
+    for (const Retired& retired : retired_) {
+      delete retired.list;
+      delete retired.function;
+    }
+  }
+
+  // Call every subscriber with args, in the order they connected. An
+  // exception of a subscriber skips the ones after it.
+  void Emit(Args... args) const {
+    EpochDomain::Section section(EpochDomain::Default());
+    const List* list = subscribers_.load(std::memory_order_acquire);
+    for (const Function* function : *list) (*function)(args...);
+  }
+
+  void Connect(Function function) {
+    std::unique_ptr<const Function> subscriber(
+        new Function(std::move(function)));
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const List* current = subscribers_.load(std::memory_order_relaxed);
+    std::unique_ptr<List> next(new List());
+    next->reserve(current->size() + 1);
+    *next = *current;
+    next->push_back(subscriber.get());
+    Publish(std::move(next), nullptr);
+    subscriber.release();
+  }
+
+  // Disconnect the first subscriber equal to function, and return whether
+  // there was one. Throws NotEqualityComparable if a subscriber of the same
+  // type cannot be compared.
+  bool Disconnect(const Function& function) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const List* current = subscribers_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < current->size(); ++i) {
+      if (*(*current)[i] == function) {
+        std::unique_ptr<List> next(new List());
+        next->reserve(current->size() - 1);
+        next->insert(next->end(), current->begin(), current->begin() + i);
+        next->insert(next->end(), current->begin() + i + 1, current->end());
+        Publish(std::move(next), (*current)[i]);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::size_t Size() const {
+    EpochDomain::Section section(EpochDomain::Default());
+    return subscribers_.load(std::memory_order_acquire)->size();
+  }
+
+  // Destroy the snapshots and subscribers no Emit() can see anymore, and
+  // return how many are still kept. Connect() and Disconnect() do this too.
+  std::size_t Reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    ReclaimLocked();
+    return retired_.size();
+  }
+
+ private:
+  using List = std::vector<const Function*>;
+
+  // A snapshot that was replaced, and the subscriber it lost if any
+  struct Retired {
+    std::uint64_t epoch;
+    const List* list;
+    const Function* function;
+  };
+
+  void Publish(std::unique_ptr<List> next, const Function* removed) {
+    // room for the old snapshot before it is unpublished, which emitters may
+    // still see and so cannot be freed if this throws
+    retired_.push_back({0, nullptr, removed});
+    Retired& retired = retired_.back();
+    retired.list =
+        subscribers_.exchange(next.release(), std::memory_order_seq_cst);
+    retired.epoch = EpochDomain::Default().Advance();
+    ReclaimLocked();
+  }
+
+  void ReclaimLocked() {
+    const std::uint64_t oldest = EpochDomain::Default().OldestReader();
+    std::size_t kept = 0;
+    for (const Retired& retired : retired_) {
+      if (retired.epoch < oldest) {
+        delete retired.list;
+        delete retired.function;
+      } else {
+        retired_[kept++] = retired;
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  std::atomic<const List*> subscribers_;
+  std::mutex writer_mutex_;
+  // Snapshots that were replaced, oldest first.
+  std::vector<Retired> retired_;
+};
+
+}  // namespace cpp_idioms
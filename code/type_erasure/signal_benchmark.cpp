@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "signal.hpp"
+
+namespace {
+
+using cpp_idioms::Signal;
+
+// The mutex-protected list of subscribers Signal replaces.
+class MutexSignal {
+ public:
+  using Function = FunctionPtr<void(int)>;
+
+  void Emit(int n) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Function& function : subscribers_) function(n);
+  }
+
+  void Connect(Function function) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.push_back(std::move(function));
+  }
+
+  bool Disconnect(const Function& function) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(subscribers_.begin(), subscribers_.end(), function);
+    if (it == subscribers_.end()) return false;
+    subscribers_.erase(it);
+    return true;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<Function> subscribers_;
+};
+
+constexpr int kSubscribers = 8;
+
+// one counter per subscriber, on a cache line of its own
+struct alignas(64) Counter {
+  std::atomic<long> value{0};
+};
+Counter counters[kSubscribers];
+
+void Ignore(int) {}
+
+template <typename SignalType>
+SignalType& Subscribed() {
+  static SignalType* signal = [] {
+    auto* signal = new SignalType();
+    for (Counter& counter : counters) {
+      signal->Connect([&counter](int n) {
+        counter.value.fetch_add(n, std::memory_order_relaxed);
+      });
+    }
+    return signal;
+  }();
+  return *signal;
+}
+
+template <typename SignalType>
+void BM_Emit(benchmark::State& state) {
+  SignalType& signal = Subscribed<SignalType>();
+  for (auto _ : state) signal.Emit(1);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Emit, MutexSignal)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Emit, Signal<void(int)>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Thread 0 connects and disconnects a subscriber while the others emit.
+template <typename SignalType>
+void BM_EmitWhileConnecting(benchmark::State& state) {
+  SignalType& signal = Subscribed<SignalType>();
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      signal.Connect(Ignore);
+      signal.Disconnect(Ignore);
+    } else {
+      signal.Emit(1);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_EmitWhileConnecting, MutexSignal)
+    ->ThreadRange(2, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_EmitWhileConnecting, Signal<void(int)>)
+    ->ThreadRange(2, 8)
+    ->UseRealTime();
+
+}  // namespace
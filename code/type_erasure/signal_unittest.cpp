@@ -0,0 +1,105 @@
+#include "signal.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+std::vector<std::string> calls;
+
+void Log(const std::string& event) { calls.push_back("log " + event); }
+void Audit(const std::string& event) { calls.push_back("audit " + event); }
+void Ignore(int) {}
+
+TEST(Signal, EmitsToSubscribersInOrder) {
+  calls.clear();
+  Signal<void(const std::string&)> signal;
+  signal.Emit("nobody");
+  signal.Connect(Log);
+  signal.Connect(Audit);
+  signal.Connect(Log);
+  EXPECT_EQ(3u, signal.Size());
+  signal.Emit("a");
+  EXPECT_EQ((std::vector<std::string>{"log a", "audit a", "log a"}), calls);
+
+  // the first equal subscriber goes
+  calls.clear();
+  EXPECT_TRUE(signal.Disconnect(Log));
+  signal.Emit("b");
+  EXPECT_EQ((std::vector<std::string>{"audit b", "log b"}), calls);
+  EXPECT_TRUE(signal.Disconnect(Log));
+  EXPECT_FALSE(signal.Disconnect(Log));
+  EXPECT_EQ(1u, signal.Size());
+  EXPECT_EQ(0u, signal.Reclaim());
+}
+
+TEST(Signal, SubscribersMayDisconnectWhileEmitting) {
+  Signal<void(int)> signal;
+  int seen = 0;
+  // disconnects the function pointer subscriber from within Emit()
+  signal.Connect([&](int n) {
+    seen += n;
+    signal.Disconnect(Ignore);
+  });
+  signal.Connect(Ignore);
+  signal.Emit(1);
+  EXPECT_EQ(1, seen);
+  EXPECT_EQ(1u, signal.Size());
+  signal.Emit(2);
+  EXPECT_EQ(3, seen);
+}
+
+TEST(Signal, ThrowingSubscriberLeavesTheEpoch) {
+  Signal<void(int)> signal;
+  int seen = 0;
+  signal.Connect([](int) { throw std::runtime_error("subscriber failed"); });
+  signal.Connect([&seen](int n) { seen += n; });
+  EXPECT_THROW(signal.Emit(1), std::runtime_error);
+  EXPECT_EQ(0, seen);
+
+  // the snapshot and subscriber replaced after the failed Emit() are freed
+  signal.Connect(Ignore);
+  EXPECT_TRUE(signal.Disconnect(Ignore));
+  EXPECT_EQ(0u, signal.Reclaim());
+  EXPECT_EQ(2u, signal.Size());
+}
+
+// Emitters on several threads while a writer keeps connecting and
+// disconnecting one subscriber.
+TEST(Signal, StressEmittersAndWriter) {
+  constexpr int kEmitters = 4;
+  constexpr int kRounds = 5000;
+  Signal<void(int)> signal;
+  std::atomic<long> always{0};
+  std::atomic<long> sometimes{0};
+  signal.Connect([&always](int n) { always += n; });
+  std::atomic<bool> done{false};
+  std::vector<std::thread> emitters;
+  for (int i = 0; i < kEmitters; ++i) {
+    emitters.emplace_back([&] {
+      while (!done.load(std::memory_order_acquire)) signal.Emit(1);
+      signal.Emit(1);
+    });
+  }
+  for (int round = 0; round < kRounds; ++round) {
+    signal.Connect([&sometimes](int n) { sometimes += n; });
+    signal.Connect(Ignore);
+    EXPECT_TRUE(signal.Disconnect(Ignore));
+    if (round % 64 == 0) std::this_thread::yield();
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread& emitter : emitters) emitter.join();
+
+  EXPECT_GE(always.load(), kEmitters);
+  EXPECT_EQ(kRounds + 1u, signal.Size());
+  EXPECT_EQ(0u, signal.Reclaim());
+}
+
+}  // namespace
+}  // namespace cpp_idioms
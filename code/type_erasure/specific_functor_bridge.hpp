@@ -1,11 +1,49 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "functor_bridge.hpp"
 #include "try_equals.hpp"
 
+// The FunctorBridge that SpecificFunctorBridge Derived extends, with
+// InvokeRange() where the signature has it.
+template <typename Derived, bool kIndexed, typename R, typename... Args>
+class SpecificFunctorRangeBridge : public FunctorBridge<R, Args...> {
+ public:
+  using FunctorBridge<R, Args...>::FunctorBridge;
+};
+
+template <typename Derived, typename R, typename Arg>
+class SpecificFunctorRangeBridge<Derived, true, R, Arg>
+    : public FunctorBridge<R, Arg> {
+ public:
+  using FunctorBridge<R, Arg>::FunctorBridge;
+
+  // A loop over the functor of this very type, which the compiler can
+  // inline into and vectorize.
+  virtual void InvokeRange(std::ptrdiff_t first,
+                           std::ptrdiff_t last) const override {
+    const auto& functor = static_cast<const Derived*>(this)->functor_;
+    for (std::ptrdiff_t i = first; i < last; ++i) {
+      functor(static_cast<Arg>(i));
+    }
+  }
+};
+
 template <typename Functor, typename R, typename... Args>
-class SpecificFunctorBridge : public FunctorBridge<R, Args...> {
+class SpecificFunctorBridge
+    : public SpecificFunctorRangeBridge<
+          SpecificFunctorBridge<Functor, R, Args...>,
+          kInvocableWithIndex<Args...>, R, Args...> {
+  using Base = SpecificFunctorRangeBridge<SpecificFunctorBridge,
+                                          kInvocableWithIndex<Args...>, R,
+                                          Args...>;
+  friend Base;
+
  public:
   template <typename FunctorFwd>
   SpecificFunctorBridge(FunctorFwd&& functor)
@@ -15,18 +53,32 @@ class SpecificFunctorBridge : public FunctorBridge<R, Args...> {
     return new SpecificFunctorBridge(functor_);
   }
 
+  virtual SpecificFunctorBridge* CloneInto(void* buffer) const override {
+    return ::new (buffer) SpecificFunctorBridge(functor_);
+  }
+
+  // only called for functors that are nothrow movable
+  virtual SpecificFunctorBridge* MoveInto(void* buffer) noexcept override {
+    return ::new (buffer) SpecificFunctorBridge(std::move_if_noexcept(functor_));
+  }
+
   virtual R Invoke(Args... args) const override {
     return functor_(std::forward<Args>(args)...);
   }
 
   virtual bool Equals(const FunctorBridge<R, Args...>* fb) const override {
-    if (auto spec_fb = dynamic_cast<const SpecificFunctorBridge*>(fb)) {
+    if (fb->TypeTag() == kFunctorTypeTag<Functor>) {
+      auto spec_fb = static_cast<const SpecificFunctorBridge*>(fb);
       return TryEquals<Functor>::Equals(functor_, spec_fb->functor_);
     }
     // functors with different types are never equal:
     return false;
   }
 
+  virtual const void* TypeTag() const noexcept override {
+    return kFunctorTypeTag<Functor>;
+  }
+
  private:
   Functor functor_;
 };
\ No newline at end of file
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "try_equals.hpp"
+
+// The operations of a FunctorBridge as a table of function pointers, shared
+// by all StaticFunctionPtrs holding the same functor type. The storage
+// argument is the buffer of a StaticFunctionPtr, which holds the functor or a
+// pointer to it.
+struct StaticFunctorTable {
+  void (*destroy)(void* storage) noexcept;
+  void (*copy)(const void* from, void* to);
+  // move and destroy the functor at from
+  void (*move)(void* from, void* to) noexcept;
+  bool (*equals)(const void* storage1, const void* storage2);
+};
+
+// The StaticFunctorTable and the invoke thunk for one functor type.
+template <typename Functor, bool Inline, typename R, typename... Args>
+struct StaticFunctorBridge {
+  static const Functor& Get(const void* storage) noexcept {
+    if constexpr (Inline) {
+      return *std::launder(static_cast<const Functor*>(storage));
+    } else {
+      return **static_cast<Functor* const*>(storage);
+    }
+  }
+
+  template <typename FunctorFwd>
+  static void Create(void* storage, FunctorFwd&& functor) {
+    if constexpr (Inline) {
+      ::new (storage) Functor(std::forward<FunctorFwd>(functor));
+    } else {
+      *static_cast<Functor**>(storage) =
+          new Functor(std::forward<FunctorFwd>(functor));
+    }
+  }
+
+  static R Invoke(const void* storage, Args... args) {
+    return Get(storage)(std::forward<Args>(args)...);
+  }
+
+  static void Destroy(void* storage) noexcept {
+    if constexpr (Inline) {
+      std::launder(static_cast<Functor*>(storage))->~Functor();
+    } else {
+      delete *static_cast<Functor**>(storage);
+    }
+  }
+
+  static void Copy(const void* from, void* to) { Create(to, Get(from)); }
+
+  static void Move(void* from, void* to) noexcept {
+    if constexpr (Inline) {
+      Functor* functor = std::launder(static_cast<Functor*>(from));
+      ::new (to) Functor(std::move(*functor));
+      functor->~Functor();
+    } else {
+      *static_cast<Functor**>(to) = *static_cast<Functor**>(from);
+    }
+  }
+
+  static bool Equals(const void* storage1, const void* storage2) {
+    return TryEquals<Functor>::Equals(Get(storage1), Get(storage2));
+  }
+
+  static constexpr StaticFunctorTable kTable = {&Destroy, &Copy, &Move,
+                                                &Equals};
+};
+
+// The default inline capacity of StaticFunctionPtr in bytes, the same room
+// for captures as FunctionPtr has, which keeps the vtable pointer of its
+// bridge inline.
+inline constexpr std::size_t kStaticFunctionPtrCapacity = 3 * sizeof(void*);
+
+// primary template
+template <typename Signature,
+          std::size_t Capacity = kStaticFunctionPtrCapacity>
+class StaticFunctionPtr;
+
+// A FunctionPtr without virtual functions. The invoke thunk of the functor
+// is stored in the object itself, so a call is one indirect jump instead of
+// loading the vtable pointer and then the slot. Copying, moving, comparing
+// and destroying go through a static table per functor type.
+template <typename R, typename... Args, std::size_t Capacity>
+class StaticFunctionPtr<R(Args...), Capacity> {
+ public:
+  // Whether a functor of type Functor is stored without allocation
+  template <typename Functor>
+  static constexpr bool kFitsInline =
+      sizeof(Functor) <= Capacity && alignof(Functor) <= alignof(void*) &&
+      std::is_nothrow_move_constructible_v<Functor>;
+
+  StaticFunctionPtr() noexcept : invoke_{nullptr}, table_{nullptr} {}
+
+  StaticFunctionPtr(const StaticFunctionPtr& other)
+      : invoke_{nullptr}, table_{nullptr} {
+    if (other.table_) {
+      other.table_->copy(other.buffer_, buffer_);
+      invoke_ = other.invoke_;
+      table_ = other.table_;
+    }
+  }
+
+  StaticFunctionPtr(StaticFunctionPtr& other)
+      : StaticFunctionPtr(static_cast<StaticFunctionPtr const&>(other)) {}
+  StaticFunctionPtr(StaticFunctionPtr&& other) noexcept
+      : invoke_{nullptr}, table_{nullptr} {
+    MoveFrom(other);
+  }
+
+  template <typename F>
+  StaticFunctionPtr(F&& f) {
+    using Functor = std::decay_t<F>;
+    using Bridge =
+        StaticFunctorBridge<Functor, kFitsInline<Functor>, R, Args...>;
+    Bridge::Create(buffer_, std::forward<F>(f));
+    invoke_ = &Bridge::Invoke;
+    table_ = &Bridge::kTable;
+  }
+
+  // assignment operators:
+  StaticFunctionPtr& operator=(const StaticFunctionPtr& other) {
+    StaticFunctionPtr temp(other);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  StaticFunctionPtr& operator=(StaticFunctionPtr&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  // construction and assignment from arbitrary function objects:
+  template <typename F>
+  StaticFunctionPtr& operator=(F&& f) {
+    StaticFunctionPtr temp(std::forward<F>(f));
+    *this = std::move(temp);
+    return *this;
+  }
+
+  ~StaticFunctionPtr() { Reset(); }
+
+  friend bool operator==(const StaticFunctionPtr& f1,
+                         const StaticFunctionPtr& f2) {
+    if (!f1 || !f2) {
+      return !f1 && !f2;
+    }
+    // functors with different types are never equal:
+    return f1.table_ == f2.table_ && f1.table_->equals(f1.buffer_, f2.buffer_);
+  }
+  friend bool operator!=(const StaticFunctionPtr& f1,
+                         const StaticFunctionPtr& f2) {
+    return !(f1 == f2);
+  }
+
+  friend void swap(StaticFunctionPtr& fp1, StaticFunctionPtr& fp2) noexcept {
+    StaticFunctionPtr temp(std::move(fp1));
+    fp1 = std::move(fp2);
+    fp2 = std::move(temp);
+  }
+
+  explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+  // invocation
+  R operator()(Args... args) const {
+    return invoke_(buffer_, std::forward<Args>(args)...);
+  }
+
+ private:
+  void Reset() noexcept {
+    if (table_) {
+      table_->destroy(buffer_);
+      invoke_ = nullptr;
+      table_ = nullptr;
+    }
+  }
+
+  // Take the functor of other, which is left empty
+  void MoveFrom(StaticFunctionPtr& other) noexcept {
+    if (other.table_) {
+      other.table_->move(other.buffer_, buffer_);
+      invoke_ = std::exchange(other.invoke_, nullptr);
+      table_ = std::exchange(other.table_, nullptr);
+    }
+  }
+
+  R (*invoke_)(const void* storage, Args... args);
+  const StaticFunctorTable* table_;
+  // The functor, or a pointer to it if it does not fit
+  alignas(void*) unsigned char buffer_[Capacity < sizeof(void*)
+                                           ? sizeof(void*)
+                                           : Capacity];
+};
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <vector>
+
+#include "function_ptr.hpp"
+#include "static_function_ptr.hpp"
+
+namespace {
+
+template <typename Function>
+__attribute__((noinline)) void ForUpTo(int n, const Function& f) {
+  for (int i = 0; i < n; ++i) {
+    f(i);
+  }
+}
+
+// The cost of the calls in a tight loop, the functor is created once. It
+// does not update memory, so calls do not wait for each other.
+template <typename Function>
+void BM_ForUpTo(benchmark::State& state) {
+  const Function f = [](int n) { benchmark::DoNotOptimize(n); };
+  for (auto _ : state) {
+    ForUpTo(state.range(0), f);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_ForUpTo, std::function<void(int)>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ForUpTo, FunctionPtr<void(int)>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ForUpTo, StaticFunctionPtr<void(int)>)->Arg(1 << 16);
+
+// Calls through many callbacks of different types, so the indirect branch
+// predictor has more to keep apart.
+template <typename Function>
+void BM_CallMixed(benchmark::State& state) {
+  std::vector<Function> callbacks;
+  for (int i = 0; i < state.range(0); ++i) {
+    if (i % 4 == 0) {
+      callbacks.emplace_back([](int n) { benchmark::DoNotOptimize(n); });
+    } else if (i % 4 == 1) {
+      callbacks.emplace_back([](int n) { benchmark::DoNotOptimize(n + 1); });
+    } else if (i % 4 == 2) {
+      callbacks.emplace_back([](int n) { benchmark::DoNotOptimize(n * 3); });
+    } else {
+      callbacks.emplace_back([](int n) { benchmark::DoNotOptimize(n ^ 5); });
+    }
+  }
+  for (auto _ : state) {
+    for (const Function& callback : callbacks) callback(1);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_CallMixed, std::function<void(int)>)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_CallMixed, FunctionPtr<void(int)>)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_CallMixed, StaticFunctionPtr<void(int)>)->Arg(4096);
+
+}  // namespace
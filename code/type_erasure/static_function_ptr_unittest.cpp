@@ -0,0 +1,83 @@
+#include "static_function_ptr.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+
+namespace {
+
+int Twice(int n) { return 2 * n; }
+
+// Counts live instances.
+struct Counted {
+  static int live;
+  Counted() { ++live; }
+  Counted(const Counted&) { ++live; }
+  Counted(Counted&&) noexcept { ++live; }
+  ~Counted() { --live; }
+  int operator()(int n) const { return n + 1; }
+};
+
+int Counted::live = 0;
+
+TEST(StaticFunctionPtr, CallsFunctors) {
+  StaticFunctionPtr<int(int)> f = Twice;
+  EXPECT_EQ(4, f(2));
+  int base = 40;
+  f = [&base](int n) { return base + n; };
+  EXPECT_EQ(42, f(2));
+
+  std::array<int, 16> values{};
+  values[3] = 7;
+  StaticFunctionPtr<int(int)> large = [values](int n) { return values[n]; };
+  EXPECT_EQ(7, large(3));
+
+  StaticFunctionPtr<std::string(std::unique_ptr<std::string>)> take =
+      [](std::unique_ptr<std::string> s) { return *s; };
+  EXPECT_EQ("text", take(std::make_unique<std::string>("text")));
+}
+
+TEST(StaticFunctionPtr, CopiesMovesAndDestroysFunctors) {
+  {
+    StaticFunctionPtr<int(int)> small = Counted{};
+    std::array<char, 64> padding{};
+    StaticFunctionPtr<int(int)> large = [c = Counted{}, padding](int n) {
+      return c(n) + padding[0];
+    };
+    EXPECT_EQ(2, Counted::live);
+
+    StaticFunctionPtr<int(int)> copy = small;
+    EXPECT_EQ(3, Counted::live);
+    copy = large;
+    EXPECT_EQ(3, Counted::live);
+    EXPECT_EQ(2, copy(1));
+
+    StaticFunctionPtr<int(int)> moved = std::move(large);
+    EXPECT_FALSE(large);
+    EXPECT_EQ(3, Counted::live);
+    swap(small, moved);
+    EXPECT_EQ(2, small(1));
+    EXPECT_EQ(2, moved(1));
+    moved = StaticFunctionPtr<int(int)>();
+    EXPECT_EQ(2, Counted::live);
+  }
+  EXPECT_EQ(0, Counted::live);
+}
+
+TEST(StaticFunctionPtr, ComparesFunctors) {
+  StaticFunctionPtr<int(int)> empty;
+  StaticFunctionPtr<int(int)> f = Twice;
+  StaticFunctionPtr<int(int)> g = f;
+  EXPECT_TRUE(empty == StaticFunctionPtr<int(int)>());
+  EXPECT_TRUE(f == g);
+  EXPECT_TRUE(f != empty);
+  // different types
+  EXPECT_TRUE(f != StaticFunctionPtr<int(int)>(Counted{}));
+  EXPECT_THROW((void)(StaticFunctionPtr<int(int)>(Counted{}) ==
+                      StaticFunctionPtr<int(int)>(Counted{})),
+               NotEqualityComparable);
+}
+
+}  // namespace
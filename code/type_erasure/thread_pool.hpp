@@ -0,0 +1,417 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpp_idioms {
+
+namespace thread_pool_internal {
+
+// A task as a few words of plain data: the invoke thunk of the functor type,
+// like the bridge of StaticFunctionPtr, and the functor itself. Functors
+// that are not trivially copyable or do not fit are allocated and the task
+// holds a pointer to them. Tasks can thus be copied with memcpy, which lets
+// thieves copy them out of a deque slot before they know they own it.
+class Task {
+ public:
+  static constexpr std::size_t kCapacity = 5 * sizeof(void*);
+
+  template <typename Functor>
+  static constexpr bool kFitsInline =
+      sizeof(Functor) <= kCapacity && alignof(Functor) <= alignof(void*) &&
+      std::is_trivially_copyable_v<Functor> &&
+      std::is_trivially_destructible_v<Functor>;
+
+  Task() noexcept = default;
+
+  template <typename F>
+  static Task Make(F&& f) {
+    using Functor = std::decay_t<F>;
+    Task task;
+    if constexpr (kFitsInline<Functor>) {
+      ::new (static_cast<void*>(task.storage_)) Functor(std::forward<F>(f));
+      task.run_ = [](void* storage) noexcept {
+        (*std::launder(static_cast<Functor*>(storage)))();
+      };
+    } else {
+      Functor* functor = new Functor(std::forward<F>(f));
+      std::memcpy(task.storage_, &functor, sizeof(functor));
+      task.run_ = [](void* storage) noexcept {
+        Functor* functor;
+        std::memcpy(&functor, storage, sizeof(functor));
+        std::unique_ptr<Functor> owner(functor);
+        (*functor)();
+      };
+    }
+    return task;
+  }
+
+  // Run the functor, which must not throw. A task runs at most once.
+  void Run() noexcept { run_(storage_); }
+
+ private:
+  void (*run_)(void* storage) noexcept = nullptr;
+  alignas(void*) unsigned char storage_[kCapacity] = {};
+};
+
+// A Chase-Lev work-stealing deque of fixed capacity. The owning thread
+// pushes and pops at the bottom, other threads steal from the top. Values
+// are kept as atomic words, so a thief that loses the race for a slot has
+// read a stale value rather than raced with the owner.
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(sizeof(T) % sizeof(std::uintptr_t) == 0);
+
+  static constexpr std::size_t kWords = sizeof(T) / sizeof(std::uintptr_t);
+
+  struct Slot {
+    std::atomic<std::uintptr_t> words[kWords];
+  };
+
+ public:
+  // capacity must be a power of two
+  explicit WorkStealingDeque(std::size_t capacity)
+      : slots_(new Slot[capacity]), mask_(capacity - 1) {}
+
+  // Owner only. False if the deque is full.
+  bool Push(const T& value) noexcept {
+    const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const std::int64_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top > static_cast<std::int64_t>(mask_)) return false;
+    Store(bottom, value);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only, newest first.
+  bool Pop(T* value) noexcept {
+    const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_release);
+      return false;
+    }
+    *value = Load(bottom);
+    if (top < bottom) return true;
+    // the last value, which thieves may be after too
+    const bool won = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return won;
+  }
+
+  // Any thread, oldest first. False if empty or another thread won.
+  bool Steal(T* value) noexcept {
+    std::int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return false;
+    T stolen = Load(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    *value = stolen;
+    return true;
+  }
+
+  bool Empty() const noexcept {
+    return top_.load(std::memory_order_acquire) >=
+           bottom_.load(std::memory_order_acquire);
+  }
+
+ private:
+  void Store(std::int64_t index, const T& value) noexcept {
+    std::uintptr_t words[kWords];
+    std::memcpy(words, &value, sizeof(T));
+    Slot& slot = slots_[index & mask_];
+    for (std::size_t i = 0; i < kWords; ++i) {
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  T Load(std::int64_t index) const noexcept {
+    std::uintptr_t words[kWords];
+    const Slot& slot = slots_[index & mask_];
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  const std::size_t mask_;
+  // thieves and the owner write different ends
+  alignas(64) std::atomic<std::int64_t> top_{0};
+  alignas(64) std::atomic<std::int64_t> bottom_{0};
+};
+
+}  // namespace thread_pool_internal
+
+// A thread pool with a work-stealing deque per worker.
+//
+//   ThreadPool pool;
+//   pool.Submit([&] { Compress(block); });
+//   pool.ParallelFor(0, n, [&](std::ptrdiff_t i) { out[i] = f(in[i]); });
+//   pool.Wait();
+//
+// Tasks submitted by a worker go to the bottom of its own deque, where it
+// takes them back newest first while idle workers steal the oldest. Tasks
+// submitted by other threads go to a shared queue. Functors that are
+// trivially copyable and fit into Task::kCapacity bytes, e.g. lambdas
+// capturing a few references and numbers, are stored in the deque slot
+// itself, so submitting them does not allocate.
+//
+// Tasks must not throw. Destroying the pool runs the tasks still queued.
+class ThreadPool {
+  using Task = thread_pool_internal::Task;
+
+ public:
+  static std::size_t DefaultThreads() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  explicit ThreadPool(std::size_t threads = DefaultThreads()) {
+    threads = std::max<std::size_t>(threads, 1);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers_.push_back(std::make_unique<Worker>(this, i));
+    }
+    for (std::unique_ptr<Worker>& worker : workers_) {
+      worker->thread = std::thread(&ThreadPool::WorkerLoop, this, worker.get());
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_.store(true, std::memory_order_release);
+    }
+    wake_.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers_) worker->thread.join();
+  }
+
+  std::size_t Size() const noexcept { return workers_.size(); }
+
+  // Run f() on a worker.
+  template <typename F>
+  void Submit(F&& f) {
+    Push(Task::Make(std::forward<F>(f)));
+  }
+
+  // Call f(i) for each i of [first, last) in parallel and return when all
+  // calls are done. The calling thread runs tasks too while it waits.
+  template <typename F>
+  void ParallelFor(std::ptrdiff_t first, std::ptrdiff_t last, const F& f) {
+    if (first >= last) return;
+    const std::ptrdiff_t size = last - first;
+    const std::ptrdiff_t chunks = std::min<std::ptrdiff_t>(
+        size, static_cast<std::ptrdiff_t>(Size() * kChunksPerWorker));
+    auto begin_of = [&](std::ptrdiff_t chunk) {
+      return first + size * chunk / chunks;
+    };
+    std::atomic<std::ptrdiff_t> remaining{chunks - 1};
+    for (std::ptrdiff_t chunk = 1; chunk < chunks; ++chunk) {
+      Submit([&f, &remaining, begin = begin_of(chunk),
+              end = begin_of(chunk + 1)] {
+        for (std::ptrdiff_t i = begin; i < end; ++i) f(i);
+        remaining.fetch_sub(1, std::memory_order_release);
+      });
+    }
+    for (std::ptrdiff_t i = first; i < begin_of(1); ++i) f(i);
+    HelpUntil([&] { return remaining.load(std::memory_order_acquire) == 0; });
+  }
+
+  // Return when every submitted task has run. The calling thread runs tasks
+  // meanwhile, and once none are left to take it sleeps until the running
+  // ones are done.
+  void Wait() {
+    if (CurrentWorker()) {
+      HelpUntil([&] { return pending_.load(std::memory_order_acquire) == 0; });
+      return;
+    }
+    while (pending_.load(std::memory_order_acquire) != 0) {
+      if (TryRunOne(nullptr)) continue;
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      waiting_.fetch_add(1, std::memory_order_seq_cst);
+      finished_.wait(lock, [&] {
+        return pending_.load(std::memory_order_seq_cst) == 0;
+      });
+      waiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static constexpr std::size_t kDequeCapacity = 4096;
+  // more chunks than workers, so that stealing can even out uneven work
+  static constexpr std::size_t kChunksPerWorker = 4;
+  static constexpr int kSpinsBeforeSleep = 64;
+
+  struct Worker {
+    Worker(ThreadPool* pool, std::size_t index)
+        : pool(pool), deque(kDequeCapacity), random(index * 2 + 1) {}
+
+    ThreadPool* const pool;
+    thread_pool_internal::WorkStealingDeque<Task> deque;
+    std::thread thread;
+    // xorshift state for picking victims
+    std::uint64_t random;
+  };
+
+  // The worker of this pool the calling thread is, or nullptr.
+  Worker* CurrentWorker() const noexcept {
+    return current_worker_ && current_worker_->pool == this ? current_worker_
+                                                            : nullptr;
+  }
+
+  void Push(const Task& task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    Worker* self = CurrentWorker();
+    if (!self || !self->deque.Push(task)) {
+      std::lock_guard<std::mutex> lock(injected_mutex_);
+      injected_.push_back(task);
+      injected_size_.fetch_add(1, std::memory_order_release);
+    }
+    // pairs with the increment of sleeping_ in WorkerLoop: either the
+    // worker sees the task or this sees the worker
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      wake_.notify_one();
+    }
+  }
+
+  // Run one task from the own deque, the shared queue or another worker.
+  bool TryRunOne(Worker* self) {
+    Task task;
+    if (!(self && self->deque.Pop(&task)) && !TryTakeInjected(&task) &&
+        !TrySteal(self, &task)) {
+      return false;
+    }
+    task.Run();
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // pairs with the increment of waiting_ in Wait(): either the waiter
+      // sees no task pending or this sees the waiter
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        finished_.notify_all();
+      }
+    }
+    return true;
+  }
+
+  bool TryTakeInjected(Task* task) {
+    if (injected_size_.load(std::memory_order_acquire) == 0) return false;
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    if (injected_.empty()) return false;
+    *task = injected_.front();
+    injected_.pop_front();
+    injected_size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool TrySteal(Worker* self, Task* task) {
+    std::size_t start = 0;
+    if (self) {
+      self->random ^= self->random << 13;
+      self->random ^= self->random >> 7;
+      self->random ^= self->random << 17;
+      start = self->random % workers_.size();
+    }
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+      Worker* victim = workers_[(start + i) % workers_.size()].get();
+      if (victim != self && victim->deque.Steal(task)) return true;
+    }
+    return false;
+  }
+
+  bool HasQueuedTasks() const noexcept {
+    if (injected_size_.load(std::memory_order_acquire) > 0) return true;
+    for (const std::unique_ptr<Worker>& worker : workers_) {
+      if (!worker->deque.Empty()) return true;
+    }
+    return false;
+  }
+
+  template <typename Done>
+  void HelpUntil(Done done) {
+    Worker* self = CurrentWorker();
+    while (!done()) {
+      if (!TryRunOne(self)) std::this_thread::yield();
+    }
+  }
+
+  void WorkerLoop(Worker* self) {
+    current_worker_ = self;
+    int idle = 0;
+    while (true) {
+      if (TryRunOne(self)) {
+        idle = 0;
+        continue;
+      }
+      if (stop_.load(std::memory_order_acquire) &&
+          pending_.load(std::memory_order_acquire) == 0) {
+        break;
+      }
+      if (++idle < kSpinsBeforeSleep) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      // pairs with the fence in Push(), before the weaker loads of the
+      // queues in HasQueuedTasks()
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!HasQueuedTasks() && !stop_.load(std::memory_order_acquire)) {
+        // the timeout only bounds the damage of a missed wake-up
+        wake_.wait_for(lock, std::chrono::milliseconds(10));
+      }
+      sleeping_.fetch_sub(1, std::memory_order_relaxed);
+      idle = 0;
+    }
+    current_worker_ = nullptr;
+  }
+
+  inline static thread_local Worker* current_worker_ = nullptr;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // submitted tasks that have not finished
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<bool> stop_{false};
+
+  // tasks from threads outside the pool, and from workers whose deque is
+  // full
+  std::mutex injected_mutex_;
+  std::deque<Task> injected_;
+  std::atomic<std::size_t> injected_size_{0};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<int> sleeping_{0};
+  // threads outside the pool in Wait(), woken when no task is pending
+  std::condition_variable finished_;
+  std::atomic<int> waiting_{0};
+};
+
+}  // namespace cpp_idioms
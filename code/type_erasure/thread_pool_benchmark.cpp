@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace {
+
+using cpp_idioms::ThreadPool;
+
+// The pool ThreadPool replaces: one queue of std::functions behind a mutex.
+class MutexThreadPool {
+ public:
+  explicit MutexThreadPool(std::size_t threads) {
+    for (std::size_t i = 0; i < threads; ++i) {
+      threads_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+
+  ~MutexThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+      ++pending_;
+    }
+    wake_.notify_one();
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+ private:
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      std::function<void()> task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+      if (--pending_ == 0) done_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::deque<std::function<void()>> tasks_;
+  std::size_t pending_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
+
+// some work per index that does not touch memory
+std::uint64_t Mix(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  return x ^ (x >> 33);
+}
+
+constexpr std::ptrdiff_t kIndices = 1 << 22;
+
+// ParallelFor over kIndices on 1 to hardware_concurrency workers
+void BM_ParallelFor(benchmark::State& state) {
+  ThreadPool pool(state.range(0));
+  std::vector<std::uint64_t> out(kIndices);
+  for (auto _ : state) {
+    pool.ParallelFor(0, kIndices, [&](std::ptrdiff_t i) { out[i] = Mix(i); });
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kIndices);
+}
+BENCHMARK(BM_ParallelFor)
+    ->DenseRange(1, ThreadPool::DefaultThreads())
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+constexpr int kTasks = 1 << 14;
+
+// many small tasks from outside the pool
+template <typename Pool>
+void BM_Submit(benchmark::State& state) {
+  Pool pool(state.range(0));
+  std::atomic<std::uint64_t> sum{0};
+  for (auto _ : state) {
+    for (int i = 0; i < kTasks; ++i) {
+      pool.Submit([&sum, i] {
+        sum.fetch_add(Mix(i), std::memory_order_relaxed);
+      });
+    }
+    pool.Wait();
+  }
+  benchmark::DoNotOptimize(sum.load());
+  state.SetItemsProcessed(state.iterations() * kTasks);
+}
+BENCHMARK_TEMPLATE(BM_Submit, MutexThreadPool)
+    ->DenseRange(1, ThreadPool::DefaultThreads())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Submit, ThreadPool)
+    ->DenseRange(1, ThreadPool::DefaultThreads())
+    ->UseRealTime();
+
+// small tasks that submit small tasks, which stay on the worker's deque
+template <typename Pool>
+void BM_SubmitFromTasks(benchmark::State& state) {
+  Pool pool(state.range(0));
+  std::atomic<std::uint64_t> sum{0};
+  constexpr int kParents = 64;
+  for (auto _ : state) {
+    for (int p = 0; p < kParents; ++p) {
+      pool.Submit([&pool, &sum] {
+        for (int i = 0; i < kTasks / kParents; ++i) {
+          pool.Submit([&sum, i] {
+            sum.fetch_add(Mix(i), std::memory_order_relaxed);
+          });
+        }
+      });
+    }
+    pool.Wait();
+  }
+  benchmark::DoNotOptimize(sum.load());
+  state.SetItemsProcessed(state.iterations() * kTasks);
+}
+BENCHMARK_TEMPLATE(BM_SubmitFromTasks, MutexThreadPool)
+    ->DenseRange(1, ThreadPool::DefaultThreads())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SubmitFromTasks, ThreadPool)
+    ->DenseRange(1, ThreadPool::DefaultThreads())
+    ->UseRealTime();
+
+}  // namespace
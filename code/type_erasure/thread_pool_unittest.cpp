@@ -0,0 +1,153 @@
+#include "thread_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace cpp_idioms {
+namespace {
+
+using thread_pool_internal::Task;
+using thread_pool_internal::WorkStealingDeque;
+
+TEST(ThreadPool, StoresSmallTrivialTasksInline) {
+  int a = 0, b = 0;
+  auto small = [&a, &b, n = 3] { a = b + n; };
+  auto owning = [p = std::make_unique<int>(1)] { ++*p; };
+  auto large = [data = std::array<char, 64>{}] { (void)data; };
+  static_assert(Task::kFitsInline<decltype(small)>);
+  static_assert(!Task::kFitsInline<decltype(owning)>);
+  static_assert(!Task::kFitsInline<decltype(large)>);
+
+  Task task = Task::Make(small);
+  b = 4;
+  task.Run();
+  EXPECT_EQ(7, a);
+  // the heap fallback runs and frees the functor, which ASan checks
+  Task::Make(std::move(owning)).Run();
+}
+
+TEST(ThreadPool, DequeStealsOldestAndPopsNewest) {
+  WorkStealingDeque<std::uintptr_t> deque(4);
+  std::uintptr_t value = 0;
+  EXPECT_FALSE(deque.Pop(&value));
+  EXPECT_FALSE(deque.Steal(&value));
+  for (std::uintptr_t i = 1; i <= 4; ++i) EXPECT_TRUE(deque.Push(i));
+  EXPECT_FALSE(deque.Push(5));
+  EXPECT_TRUE(deque.Steal(&value));
+  EXPECT_EQ(1u, value);
+  EXPECT_TRUE(deque.Pop(&value));
+  EXPECT_EQ(4u, value);
+  // wraps around
+  EXPECT_TRUE(deque.Push(6));
+  EXPECT_TRUE(deque.Push(7));
+  std::vector<std::uintptr_t> popped;
+  while (deque.Pop(&value)) popped.push_back(value);
+  EXPECT_EQ((std::vector<std::uintptr_t>{7, 6, 3, 2}), popped);
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(ThreadPool, DequeHandsOutEachValueOnce) {
+  constexpr std::uintptr_t kValues = 100000;
+  WorkStealingDeque<std::uintptr_t> deque(64);
+  std::vector<std::atomic<int>> seen(kValues);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < 3; ++t) {
+    thieves.emplace_back([&] {
+      std::uintptr_t value;
+      while (!done.load(std::memory_order_acquire)) {
+        if (deque.Steal(&value)) seen[value].fetch_add(1);
+      }
+      while (deque.Steal(&value)) seen[value].fetch_add(1);
+    });
+  }
+  std::uintptr_t value;
+  for (std::uintptr_t i = 0; i < kValues; ++i) {
+    while (!deque.Push(i)) {
+      if (deque.Pop(&value)) seen[value].fetch_add(1);
+    }
+    if (i % 3 == 0 && deque.Pop(&value)) seen[value].fetch_add(1);
+  }
+  while (deque.Pop(&value)) seen[value].fetch_add(1);
+  done.store(true, std::memory_order_release);
+  for (std::thread& thief : thieves) thief.join();
+  for (std::uintptr_t i = 0; i < kValues; ++i) ASSERT_EQ(1, seen[i].load());
+}
+
+TEST(ThreadPool, RunsSubmittedTasks) {
+  std::atomic<int> sum{0};
+  {
+    ThreadPool pool(3);
+    EXPECT_EQ(3u, pool.Size());
+    for (int i = 1; i <= 100; ++i) {
+      pool.Submit([&sum, i] { sum.fetch_add(i); });
+    }
+    pool.Wait();
+    EXPECT_EQ(5050, sum.load());
+
+    // tasks submitted by tasks, which go to the worker's own deque
+    for (int i = 0; i < 10; ++i) {
+      pool.Submit([&] {
+        for (int j = 0; j < 10; ++j) pool.Submit([&sum] { sum.fetch_add(1); });
+      });
+    }
+    pool.Wait();
+    EXPECT_EQ(5150, sum.load());
+
+    // the destructor runs what is still queued
+    pool.Submit([&sum, p = std::make_unique<int>(7)] { sum.fetch_add(*p); });
+  }
+  EXPECT_EQ(5157, sum.load());
+}
+
+TEST(ThreadPool, WaitSleepsWhileTasksRun) {
+  ThreadPool pool(2);
+  std::atomic<int> done{0};
+  for (int i = 0; i < 2; ++i) {
+    pool.Submit([&done] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+      done.fetch_add(1);
+    });
+  }
+  // let the workers take both tasks, so that Wait() has none to run
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const std::clock_t start = std::clock();
+  pool.Wait();
+  const double cpu_seconds =
+      static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  EXPECT_EQ(2, done.load());
+  // spinning would have used about a quarter of a second
+  EXPECT_LT(cpu_seconds, 0.1);
+}
+
+TEST(ThreadPool, ParallelForCoversTheRangeOnce) {
+  ThreadPool pool(4);
+  std::vector<int> counts(10007);
+  pool.ParallelFor(0, counts.size(), [&](std::ptrdiff_t i) { ++counts[i]; });
+  EXPECT_EQ(std::vector<int>(counts.size(), 1), counts);
+
+  // ranges smaller than the pool and empty ones
+  std::vector<int> few(3);
+  pool.ParallelFor(0, 3, [&](std::ptrdiff_t i) { few[i] = i + 1; });
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), few);
+  pool.ParallelFor(5, 5, [](std::ptrdiff_t) { FAIL(); });
+
+  // nested in tasks, whose workers help while they wait
+  std::vector<long> sums(8);
+  pool.ParallelFor(0, 8, [&](std::ptrdiff_t row) {
+    std::atomic<long> sum{0};
+    pool.ParallelFor(0, 1000, [&](std::ptrdiff_t i) { sum.fetch_add(i); });
+    sums[row] = sum.load();
+  });
+  EXPECT_EQ(std::vector<long>(8, 499500), sums);
+}
+
+}  // namespace
+}  // namespace cpp_idioms
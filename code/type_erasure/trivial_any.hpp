@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "any.hpp"
+#include "type_id.hpp"
+
+namespace cpp_idioms {
+
+// A tag for TrivialTypeTag, the hash of a name chosen for a type. The name
+// only needs to be unique among the types that share a TrivialAny.
+constexpr std::uint64_t TrivialTypeTagOf(std::string_view name) noexcept {
+  return type_id_internal::Hash(name);
+}
+
+// The tag TrivialAny stores for a T, which must name T in every process that
+// reads it, independent of where the binary is loaded. Types other than
+// arithmetic ones get their tag explicitly:
+//
+//   template <>
+//   struct cpp_idioms::TrivialTypeTag<market::Quote> {
+//     static constexpr std::uint64_t value = TrivialTypeTagOf("market.Quote");
+//   };
+//
+// A tag derived from how the compiler spells a type would not be safe here:
+// types in anonymous namespaces of different translation units, or closures
+// and local classes, can be spelled alike, and TrivialAnyCast would then
+// read the bytes of one as the other. Only the names of arithmetic types
+// are unique, so only they are tagged by name.
+template <typename T, typename = void>
+struct TrivialTypeTag {};
+
+template <typename T>
+struct TrivialTypeTag<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+  static constexpr std::uint64_t value =
+      type_id_internal::Hash(TypeName<T>());
+};
+
+namespace trivial_any_internal {
+
+template <typename T, typename = void>
+struct HasTag : std::false_type {};
+
+template <typename T>
+struct HasTag<T, std::void_t<decltype(TrivialTypeTag<T>::value)>>
+    : std::true_type {};
+
+template <typename T>
+constexpr std::uint64_t TagOf() noexcept {
+  static_assert(HasTag<T>::value,
+                "Specialize TrivialTypeTag<T> to give T a tag that names it "
+                "in every process");
+  if constexpr (HasTag<T>::value) {
+    static_assert(TrivialTypeTag<T>::value != 0,
+                  "The tag 0 stands for an empty TrivialAny");
+    return TrivialTypeTag<T>::value;
+  } else {
+    return 0;
+  }
+}
+
+}  // namespace trivial_any_internal
+
+template <typename T>
+inline constexpr std::uint64_t kTrivialTypeTag =
+    trivial_any_internal::TagOf<T>();
+
+// An any object for trivially copyable types only, which is itself
+// trivially copyable. It holds a type tag and the bytes of the value in
+// place, no function or heap pointer, so it can be copied with memcpy and
+// placed in memory shared between processes, e.g. the slots of a ring
+// buffer in an mmap()ed region. Values must not point into the memory of
+// the process that stored them.
+template <std::size_t Size, std::size_t Align = alignof(std::max_align_t)>
+class TrivialAny {
+ public:
+  // Whether a Tp can be stored
+  template <typename Tp>
+  static constexpr bool Accepts() noexcept {
+    return std::is_trivially_copyable_v<Tp> && !std::is_pointer_v<Tp> &&
+           sizeof(Tp) <= Size && alignof(Tp) <= Align;
+  }
+
+  // Default constructor, create an empty object.
+  TrivialAny() noexcept = default;
+
+  // Construct with a copy of value as the contained object
+  template <typename ValueType, typename Tp = std::decay_t<ValueType>,
+            std::enable_if_t<!std::is_same_v<Tp, TrivialAny>, bool> = true>
+  TrivialAny(const ValueType& value) noexcept {
+    Emplace<Tp>(value);
+  }
+
+  // Store a copy of value as the contained object
+  template <typename Tp>
+  Tp& Emplace(const Tp& value) noexcept {
+    static_assert(Accepts<Tp>(),
+                  "TrivialAny holds trivially copyable non-pointer types that "
+                  "fit into its buffer");
+    tag_ = kTrivialTypeTag<Tp>;
+    if constexpr (sizeof(Tp) < Size) {
+      std::memset(buffer_ + sizeof(Tp), 0, Size - sizeof(Tp));
+    }
+    return *::new (static_cast<void*>(buffer_)) Tp(value);
+  }
+
+  void Reset() noexcept {
+    tag_ = 0;
+    std::memset(buffer_, 0, Size);
+  }
+
+  bool HasValue() const noexcept { return tag_ != 0; }
+
+  // The tag of the contained type, or 0 if empty
+  std::uint64_t Tag() const noexcept { return tag_; }
+
+  template <typename Tp>
+  bool Holds() const noexcept {
+    return tag_ == kTrivialTypeTag<Tp>;
+  }
+
+  // The address of the contained object, which must be a Tp.
+  template <typename Tp>
+  const Tp* UncheckedGet() const noexcept {
+    return std::launder(reinterpret_cast<const Tp*>(buffer_));
+  }
+
+  template <typename Tp>
+  Tp* UncheckedGet() noexcept {
+    return std::launder(reinterpret_cast<Tp*>(buffer_));
+  }
+
+ private:
+  std::uint64_t tag_ = 0;
+  // The bytes the contained object does not cover are zero, so that no
+  // stale bytes of earlier values leak into shared memory. Padding within
+  // the object is copied from the value as it is.
+  alignas(Align) unsigned char buffer_[Size] = {};
+};
+
+template <typename ValueType, std::size_t Size, std::size_t Align>
+inline const ValueType* TrivialAnyCast(
+    const TrivialAny<Size, Align>* any) noexcept {
+  if (any && any->template Holds<ValueType>()) {
+    return any->template UncheckedGet<ValueType>();
+  }
+  return nullptr;
+}
+
+template <typename ValueType, std::size_t Size, std::size_t Align>
+inline ValueType* TrivialAnyCast(TrivialAny<Size, Align>* any) noexcept {
+  if (any && any->template Holds<ValueType>()) {
+    return any->template UncheckedGet<ValueType>();
+  }
+  return nullptr;
+}
+
+// Copy the contained object out
+template <typename ValueType, std::size_t Size, std::size_t Align>
+inline ValueType TrivialAnyCast(const TrivialAny<Size, Align>& any) {
+  if (!any.template Holds<ValueType>()) ThrowBadAnyCast();
+  return *any.template UncheckedGet<ValueType>();
+}
+
+// The types a receiver knows about, to turn the tags of TrivialAny objects
+// from another process back into types.
+//
+//   using Messages = TrivialAnyRegistry<Ping, Quote, Order>;
+//   bool known = Messages::Visit(slot, Overloaded{
+//       [](const Ping& ping) { ... },
+//       [](const Quote& quote) { ... },
+//       [](const Order& order) { ... }});
+template <typename... Ts>
+class TrivialAnyRegistry {
+  static constexpr std::uint64_t kTags[] = {kTrivialTypeTag<Ts>...};
+
+  static constexpr bool TagsAreUnique() {
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+      for (std::size_t j = 0; j < i; ++j) {
+        if (kTags[i] == kTags[j]) return false;
+      }
+    }
+    return true;
+  }
+
+  static_assert(sizeof...(Ts) > 0, "An empty registry knows no types");
+  static_assert((std::is_trivially_copyable_v<Ts> && ...),
+                "TrivialAny holds trivially copyable types only");
+  static_assert(TagsAreUnique(), "Two types of the registry share a tag");
+
+ public:
+  static constexpr bool Contains(std::uint64_t tag) noexcept {
+    return ((tag == kTrivialTypeTag<Ts>) || ...);
+  }
+
+  // The name of the type with tag, or an empty name for unknown tags.
+  static constexpr std::string_view NameOf(std::uint64_t tag) noexcept {
+    std::string_view name;
+    ((tag == kTrivialTypeTag<Ts> ? (name = TypeName<Ts>(), true) : false) ||
+     ...);
+    return name;
+  }
+
+  /// Call @p visitor with a copy of the contained object of @p any. Returns
+  /// false, without calling it, for empty objects and unknown types.
+  template <std::size_t Size, std::size_t Align, typename Visitor>
+  static bool Visit(const TrivialAny<Size, Align>& any, Visitor&& visitor) {
+    return ((any.template Holds<Ts>()
+                 ? (visitor(TrivialAnyCast<Ts>(any)), true)
+                 : false) ||
+            ...);
+  }
+};
+
+}  // namespace cpp_idioms
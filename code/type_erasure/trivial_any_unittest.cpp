@@ -0,0 +1,211 @@
+#include "trivial_any.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace cpp_idioms {
+namespace {
+
+struct Ping {
+  std::uint32_t sequence;
+};
+
+struct Quote {
+  char symbol[8];
+  double price;
+  std::int64_t quantity;
+};
+
+struct Shutdown {};
+
+}  // namespace
+
+template <>
+struct TrivialTypeTag<Ping> {
+  static constexpr std::uint64_t value = TrivialTypeTagOf("test.Ping");
+};
+
+template <>
+struct TrivialTypeTag<Quote> {
+  static constexpr std::uint64_t value = TrivialTypeTagOf("test.Quote");
+};
+
+template <>
+struct TrivialTypeTag<Shutdown> {
+  static constexpr std::uint64_t value = TrivialTypeTagOf("test.Shutdown");
+};
+
+namespace {
+
+using Slot = TrivialAny<24, 8>;
+using Messages = TrivialAnyRegistry<Ping, Quote, Shutdown>;
+
+static_assert(std::is_trivially_copyable_v<Slot>);
+static_assert(std::is_standard_layout_v<Slot>);
+static_assert(sizeof(Slot) == 32);
+static_assert(Slot::Accepts<Quote>());
+static_assert(!Slot::Accepts<Quote*>());
+static_assert(!Slot::Accepts<char[32]>());
+static_assert(kTrivialTypeTag<Ping> != kTrivialTypeTag<Quote>);
+static_assert(Messages::Contains(kTrivialTypeTag<Shutdown>));
+static_assert(!Messages::Contains(kTrivialTypeTag<int>));
+static_assert(Messages::NameOf(kTrivialTypeTag<int>).empty());
+
+TEST(TrivialAny, StoresAndCasts) {
+  Slot slot;
+  EXPECT_FALSE(slot.HasValue());
+  slot = Quote{"ACME", 12.5, 100};
+  EXPECT_TRUE(slot.Holds<Quote>());
+  EXPECT_EQ(12.5, TrivialAnyCast<Quote>(slot).price);
+  EXPECT_EQ(nullptr, TrivialAnyCast<Ping>(&slot));
+  EXPECT_THROW(TrivialAnyCast<Ping>(slot), BadAnyCast);
+
+  TrivialAnyCast<Quote>(&slot)->quantity = 5;
+  EXPECT_EQ(5, TrivialAnyCast<Quote>(slot).quantity);
+  slot.Reset();
+  EXPECT_FALSE(slot.HasValue());
+}
+
+TEST(TrivialAny, ZeroesWhatTheValueDoesNotCover) {
+  Slot slot = Quote{"ACME", 12.5, 100};
+  slot = Ping{7};
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&slot);
+  for (std::size_t i = sizeof(std::uint64_t) + sizeof(Ping); i < sizeof(Slot);
+       ++i) {
+    EXPECT_EQ(0, bytes[i]) << i;
+  }
+  slot.Reset();
+  for (std::size_t i = 0; i < sizeof(Slot); ++i) EXPECT_EQ(0, bytes[i]) << i;
+}
+
+TEST(TrivialAny, CopiesAsBytes) {
+  Slot from = Ping{7};
+  unsigned char bytes[sizeof(Slot)];
+  std::memcpy(bytes, &from, sizeof(Slot));
+  Slot to;
+  std::memcpy(&to, bytes, sizeof(Slot));
+  EXPECT_EQ(7u, TrivialAnyCast<Ping>(to).sequence);
+}
+
+TEST(TrivialAny, RegistryVisitsKnownTypes) {
+  Slot slot = Ping{3};
+  std::uint32_t sequence = 0;
+  EXPECT_TRUE(Messages::Visit(slot, [&](const auto& message) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(message)>, Ping>)
+      sequence = message.sequence;
+  }));
+  EXPECT_EQ(3u, sequence);
+  EXPECT_EQ(TypeName<Ping>(), Messages::NameOf(slot.Tag()));
+
+  slot = 1.5;
+  EXPECT_FALSE(Messages::Visit(slot, [](const auto&) { FAIL(); }));
+  slot.Reset();
+  EXPECT_FALSE(Messages::Visit(slot, [](const auto&) { FAIL(); }));
+}
+
+#if defined(__linux__)
+
+// A single-producer, single-consumer ring in memory shared by two processes.
+struct Ring {
+  static constexpr std::uint32_t kCapacity = 64;
+
+  bool Push(const Slot& slot) {
+    std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) return false;
+    slots_[tail % kCapacity] = slot;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Pop(Slot* slot) {
+    std::uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    *slot = slots_[head % kCapacity];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::atomic<std::uint32_t> head_{0};
+  std::atomic<std::uint32_t> tail_{0};
+  Slot slots_[kCapacity];
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+TEST(TrivialAny, PassesBetweenProcesses) {
+  constexpr std::uint32_t kMessages = 10000;
+  void* memory = mmap(nullptr, sizeof(Ring), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, memory);
+  Ring* ring = ::new (memory) Ring;
+
+  pid_t child = fork();
+  ASSERT_NE(-1, child);
+  if (child == 0) {
+    // producer
+    for (std::uint32_t i = 0; i < kMessages; ++i) {
+      Slot slot;
+      if (i % 2 == 0) {
+        slot = Ping{i};
+      } else {
+        slot = Quote{"ACME", static_cast<double>(i), i};
+      }
+      while (!ring->Push(slot)) sched_yield();
+    }
+    while (!ring->Push(Slot(Shutdown{}))) sched_yield();
+    _exit(0);
+  }
+
+  // consumer
+  std::uint32_t pings = 0;
+  std::uint32_t quotes = 0;
+  std::uint32_t errors = 0;
+  bool done = false;
+  while (!done) {
+    Slot slot;
+    if (!ring->Pop(&slot)) {
+      sched_yield();
+      continue;
+    }
+    bool known = Messages::Visit(slot, [&](const auto& message) {
+      using Message = std::decay_t<decltype(message)>;
+      if constexpr (std::is_same_v<Message, Ping>) {
+        if (message.sequence != 2 * pings) ++errors;
+        ++pings;
+      } else if constexpr (std::is_same_v<Message, Quote>) {
+        if (message.quantity != 2 * quotes + 1 ||
+            message.price != static_cast<double>(message.quantity)) {
+          ++errors;
+        }
+        ++quotes;
+      } else {
+        done = true;
+      }
+    });
+    if (!known) ++errors;
+  }
+
+  int status = 0;
+  ASSERT_EQ(child, waitpid(child, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  EXPECT_EQ(kMessages / 2, pings);
+  EXPECT_EQ(kMessages / 2, quotes);
+  EXPECT_EQ(0u, errors);
+  ring->~Ring();
+  munmap(memory, sizeof(Ring));
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace cpp_idioms
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define CPP_IDIOMS_HAS_RTTI 1
+#else
+#define CPP_IDIOMS_HAS_RTTI 0
+#endif
+
+#if defined(__GNUC__)
+#define CPP_IDIOMS_VISIBLE __attribute__((visibility("default")))
+#else
+#define CPP_IDIOMS_VISIBLE
+#endif
+
+namespace cpp_idioms {
+
+namespace type_id_internal {
+
+// The signature of this function spells out T, e.g. with gcc
+// "constexpr std::string_view ...::Signature() [with T = int; ...]".
+template <typename T>
+constexpr std::string_view Signature() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+
+// 64-bit FNV-1a
+constexpr std::uint64_t Hash(std::string_view s) noexcept {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (char c : s) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// A variable of its own per type. Its default visibility lets the dynamic
+// linker merge its copies in shared libraries built with -fvisibility=hidden
+// whenever T is exported from them.
+template <typename T>
+struct CPP_IDIOMS_VISIBLE TagAnchor {
+  static constexpr char kAddress = 0;
+};
+
+}  // namespace type_id_internal
+
+// The name of T as spelled by the compiler, for diagnostics only.
+template <typename T>
+constexpr std::string_view TypeName() noexcept {
+  constexpr std::string_view signature = type_id_internal::Signature<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+  constexpr std::string_view prefix = "Signature<";
+  constexpr std::string_view suffix = ">(void) noexcept";
+#elif defined(__clang__)
+  constexpr std::string_view prefix = "[T = ";
+  constexpr std::string_view suffix = "]";
+#else
+  constexpr std::string_view prefix = "[with T = ";
+  constexpr std::string_view suffix = "; std::string_view";
+#endif
+  constexpr std::size_t begin = signature.find(prefix) + prefix.size();
+  constexpr std::size_t end = signature.rfind(suffix);
+  return signature.substr(begin, end - begin);
+}
+
+// A compile-time identity of a type that needs neither RTTI nor a unique
+// symbol address. It is a hash of the type's name, so the same type gets the
+// same id in every shared library and every process built from the same
+// sources, and comparing two ids is one integer comparison.
+//
+// Types are told apart by their names only. Equal types have equal ids, so
+// different ids rule a type out, but types of the same name share an id:
+// types in anonymous namespaces of different translation units, and local
+// classes and closures that the compiler spells alike, e.g. two lambdas of
+// one function with the same parameters. kTypeTag tells those apart.
+class TypeId {
+ public:
+  // The id of no type, e.g. of an empty any object.
+  constexpr TypeId() noexcept : value_(0) {}
+
+  template <typename T>
+  static constexpr TypeId Of() noexcept {
+    return TypeId(type_id_internal::Hash(type_id_internal::Signature<T>()));
+  }
+
+  constexpr std::uint64_t Value() const noexcept { return value_; }
+
+  friend constexpr bool operator==(TypeId lhs, TypeId rhs) noexcept {
+    return lhs.value_ == rhs.value_;
+  }
+  friend constexpr bool operator!=(TypeId lhs, TypeId rhs) noexcept {
+    return lhs.value_ != rhs.value_;
+  }
+  friend constexpr bool operator<(TypeId lhs, TypeId rhs) noexcept {
+    return lhs.value_ < rhs.value_;
+  }
+
+ private:
+  explicit constexpr TypeId(std::uint64_t value) noexcept : value_(value) {}
+
+  std::uint64_t value_;
+};
+
+// The id of T as a constant, so that it is never computed at run time.
+template <typename T>
+inline constexpr TypeId kTypeId = TypeId::Of<T>();
+
+// An identity of T that no other type shares, the address of a variable of
+// its own. Shared libraries agree on it when T is exported from them, but
+// unlike a TypeId it is not a constant and differs between processes.
+template <typename T>
+inline constexpr const void* kTypeTag =
+    &type_id_internal::TagAnchor<T>::kAddress;
+
+}  // namespace cpp_idioms
@@ -0,0 +1,83 @@
+// Built with -fno-rtti: neither TypeId nor Any may depend on typeid.
+
+#include "type_id.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "any.hpp"
+
+namespace cpp_idioms {
+namespace {
+
+static_assert(!CPP_IDIOMS_HAS_RTTI, "this test must be built with -fno-rtti");
+
+struct Point {
+  int x;
+  int y;
+};
+
+namespace other {
+struct Point {
+  int x;
+  int y;
+};
+}  // namespace other
+
+static_assert(kTypeId<int> == TypeId::Of<int>());
+static_assert(kTypeId<int> != kTypeId<long>);
+static_assert(kTypeId<int> != kTypeId<const int>);
+static_assert(kTypeId<Point> != kTypeId<other::Point>);
+static_assert(kTypeId<int>.Value() != TypeId().Value());
+
+TEST(TypeId, NamesTypes) {
+  EXPECT_EQ("int", TypeName<int>());
+  EXPECT_NE(std::string_view::npos, TypeName<other::Point>().find("other::Point"));
+}
+
+TEST(TypeId, AnyCastWithoutRtti) {
+  Any a = Point{1, 2};
+  EXPECT_EQ(kTypeId<Point>, a.GetTypeId());
+  EXPECT_EQ(2, AnyCast<Point>(a).y);
+  EXPECT_EQ(nullptr, AnyCast<other::Point>(&a));
+  EXPECT_THROW(AnyCast<int>(a), BadAnyCast);
+
+  a = std::string("s");
+  EXPECT_EQ(kTypeId<std::string>, a.GetTypeId());
+  a.Reset();
+  EXPECT_EQ(TypeId(), a.GetTypeId());
+}
+
+TEST(TypeId, AnyTellsTypesOfOneNameApart) {
+  // gcc spells both "...::<lambda(int)>"
+  auto first = [](int n) { return n; };
+  auto second = [](int n) { return n + 1; };
+  EXPECT_NE(kTypeTag<decltype(first)>, kTypeTag<decltype(second)>);
+  EXPECT_NE(kTypeTag<int>, kTypeTag<const int>);
+  Any a = first;
+  Any b = second;
+  EXPECT_EQ(nullptr, AnyCast<decltype(second)>(&a));
+  EXPECT_NE(nullptr, AnyCast<decltype(first)>(&a));
+  EXPECT_FALSE(a.Equals(b));
+
+  // local classes of one name in two scopes
+  {
+    struct Local {
+      int value;
+    };
+    a = Local{1};
+    EXPECT_EQ(1, AnyCast<Local>(a).value);
+  }
+  {
+    struct Local {
+      long value;
+    };
+    EXPECT_EQ(nullptr, AnyCast<Local>(&a));
+    b = Local{1};
+    EXPECT_FALSE(a.Equals(b));
+  }
+}
+
+}  // namespace
+}  // namespace cpp_idioms
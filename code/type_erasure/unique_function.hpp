@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// The bridge of UniqueFunction, which has no Clone, so functors need only be
+// movable.
+template <typename R, typename... Args>
+class UniqueFunctorBridge {
+ public:
+  virtual ~UniqueFunctorBridge() {}
+  // Move the bridge into the storage at buffer, which is large and aligned
+  // enough for it.
+  virtual UniqueFunctorBridge* MoveInto(void* buffer) noexcept = 0;
+  virtual R Invoke(Args... args) = 0;
+};
+
+template <typename Functor, typename R, typename... Args>
+class SpecificUniqueFunctorBridge : public UniqueFunctorBridge<R, Args...> {
+ public:
+  template <typename FunctorFwd>
+  SpecificUniqueFunctorBridge(FunctorFwd&& functor)
+      : functor_(std::forward<FunctorFwd>(functor)) {}
+
+  // only called for functors that are nothrow movable
+  virtual SpecificUniqueFunctorBridge* MoveInto(
+      void* buffer) noexcept override {
+    return ::new (buffer) SpecificUniqueFunctorBridge(std::move(functor_));
+  }
+
+  virtual R Invoke(Args... args) override {
+    if constexpr (std::is_void_v<R>) {
+      functor_(std::forward<Args>(args)...);
+    } else {
+      return functor_(std::forward<Args>(args)...);
+    }
+  }
+
+ private:
+  Functor functor_;
+};
+
+// The default inline capacity of UniqueFunction in bytes, which holds the
+// vtable pointer of the bridge, a std::promise and a std::unique_ptr.
+inline constexpr std::size_t kUniqueFunctionCapacity = 6 * sizeof(void*);
+
+// primary template
+template <typename Signature, std::size_t Capacity = kUniqueFunctionCapacity>
+class UniqueFunction;
+
+// A move-only FunctionPtr, for functors that own resources such as buffers
+// in a std::unique_ptr or a std::promise, e.g. tasks passed through a queue.
+//
+//   std::promise<int> promise;
+//   std::future<int> result = promise.get_future();
+//   UniqueFunction<void()> task = [promise = std::move(promise)]() mutable {
+//     promise.set_value(42);
+//   };
+//   queue.Push(std::move(task));
+//
+// Functors whose bridge fits into Capacity bytes and that are nothrow
+// movable are stored inline and moved along with the UniqueFunction, others
+// are allocated once and handed over by pointer. Calls may modify the
+// functor, like calls of a mutable lambda.
+template <typename R, typename... Args, std::size_t Capacity>
+class UniqueFunction<R(Args...), Capacity> {
+  using Bridge = UniqueFunctorBridge<R, Args...>;
+
+ public:
+  // Whether a functor of type Functor is stored without allocation
+  template <typename Functor>
+  static constexpr bool kFitsInline =
+      sizeof(SpecificUniqueFunctorBridge<Functor, R, Args...>) <= Capacity &&
+      alignof(SpecificUniqueFunctorBridge<Functor, R, Args...>) <=
+          alignof(Bridge) &&
+      std::is_nothrow_move_constructible_v<Functor>;
+
+  UniqueFunction() noexcept : bridge_{nullptr} {}
+
+  UniqueFunction(const UniqueFunction&) = delete;
+  UniqueFunction(UniqueFunction&& other) noexcept : bridge_{nullptr} {
+    MoveFrom(other);
+  }
+
+  template <typename F,
+            std::enable_if_t<!std::is_same_v<std::decay_t<F>, UniqueFunction>,
+                             bool> = true>
+  UniqueFunction(F&& f) : bridge_{nullptr} {
+    using Functor = std::decay_t<F>;
+    using SpecificBridge = SpecificUniqueFunctorBridge<Functor, R, Args...>;
+    if constexpr (kFitsInline<Functor>) {
+      bridge_ = ::new (Buffer()) SpecificBridge(std::forward<F>(f));
+    } else {
+      bridge_ = new SpecificBridge(std::forward<F>(f));
+    }
+  }
+
+  UniqueFunction& operator=(const UniqueFunction&) = delete;
+  UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~UniqueFunction() { Reset(); }
+
+  friend void swap(UniqueFunction& f1, UniqueFunction& f2) noexcept {
+    UniqueFunction temp(std::move(f1));
+    f1 = std::move(f2);
+    f2 = std::move(temp);
+  }
+
+  explicit operator bool() const noexcept { return bridge_ != nullptr; }
+
+  // Whether the functor lives in the object itself
+  bool IsStoredInline() const noexcept {
+    return bridge_ == reinterpret_cast<const Bridge*>(buffer_);
+  }
+
+  // invocation
+  R operator()(Args... args) {
+    return bridge_->Invoke(std::forward<Args>(args)...);
+  }
+
+ private:
+  void* Buffer() noexcept { return buffer_; }
+
+  void Reset() noexcept {
+    if (IsStoredInline()) {
+      bridge_->~Bridge();
+    } else {
+      delete bridge_;
+    }
+    bridge_ = nullptr;
+  }
+
+  // Take the functor of other, which is left empty
+  void MoveFrom(UniqueFunction& other) noexcept {
+    if (other.IsStoredInline()) {
+      bridge_ = other.bridge_->MoveInto(Buffer());
+      other.Reset();
+    } else {
+      bridge_ = other.bridge_;
+      other.bridge_ = nullptr;
+    }
+  }
+
+  Bridge* bridge_;
+  alignas(Bridge) unsigned char buffer_[Capacity];
+};
@@ -0,0 +1,82 @@
+#include "unique_function.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace {
+
+static_assert(!std::is_copy_constructible_v<UniqueFunction<void()>>);
+static_assert(std::is_nothrow_move_constructible_v<UniqueFunction<void()>>);
+
+// Counts moves and live instances.
+struct Counted {
+  static int live;
+  static int moves;
+  Counted() { ++live; }
+  Counted(Counted&&) noexcept {
+    ++live;
+    ++moves;
+  }
+  ~Counted() { --live; }
+};
+
+int Counted::live = 0;
+int Counted::moves = 0;
+
+TEST(UniqueFunction, HoldsMoveOnlyFunctors) {
+  auto buffer = std::make_unique<std::string>("payload");
+  std::promise<std::size_t> promise;
+  std::future<std::size_t> result = promise.get_future();
+  UniqueFunction<void()> task = [buffer = std::move(buffer),
+                                 promise = std::move(promise)]() mutable {
+    promise.set_value(buffer->size());
+  };
+  EXPECT_TRUE(task.IsStoredInline());
+
+  // through a queue and back out
+  std::deque<UniqueFunction<void()>> queue;
+  queue.push_back(std::move(task));
+  EXPECT_FALSE(task);
+  UniqueFunction<void()> next = std::move(queue.front());
+  queue.pop_front();
+  next();
+  EXPECT_EQ(7u, result.get());
+}
+
+TEST(UniqueFunction, CallsMayModifyTheFunctor) {
+  UniqueFunction<int()> counter = [n = 0]() mutable { return ++n; };
+  EXPECT_EQ(1, counter());
+  EXPECT_EQ(2, counter());
+  UniqueFunction<int()> moved = std::move(counter);
+  EXPECT_EQ(3, moved());
+}
+
+TEST(UniqueFunction, MovesInlineFunctorsAndHandsOverOthers) {
+  {
+    UniqueFunction<void()> small = [c = Counted{}] {};
+    std::array<char, 128> padding{};
+    UniqueFunction<void()> large = [c = Counted{}, padding] {};
+    EXPECT_TRUE(small.IsStoredInline());
+    EXPECT_FALSE(large.IsStoredInline());
+    EXPECT_EQ(2, Counted::live);
+
+    Counted::moves = 0;
+    UniqueFunction<void()> moved_small = std::move(small);
+    UniqueFunction<void()> moved_large = std::move(large);
+    EXPECT_EQ(1, Counted::moves);
+
+    swap(moved_small, moved_large);
+    EXPECT_FALSE(moved_small.IsStoredInline());
+    EXPECT_TRUE(moved_large.IsStoredInline());
+    moved_small = UniqueFunction<void()>();
+    EXPECT_EQ(1, Counted::live);
+  }
+  EXPECT_EQ(0, Counted::live);
+}
+
+}  // namespace
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cpp_idioms {
+
+// The number of calls to the global operator new so far. Tests that link
+// //utils:allocation_counter, which replaces the global allocation and
+// deallocation functions, use it to tell in-place storage from the heap.
+std::size_t AllocationCount() noexcept;
+
+}  // namespace cpp_idioms
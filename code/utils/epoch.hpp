@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace cpp_idioms {
+
+// Epoch-based reclamation for data that many threads read without locks.
+//
+// Readers bracket each access with Enter() and Exit(), which announce the
+// global epoch they started in. A writer that unlinks an object calls
+// Advance() and keeps the object until OldestReader() is past the epoch
+// Advance() returned; by then every reader that could have seen the object
+// has left.
+//
+//   // reader                         // writer
+//   auto* slot = domain.Enter();      Node* old = head.exchange(next);
+//   Read(head.load());                auto epoch = domain.Advance();
+//   domain.Exit(slot);                ...
+//                                     if (epoch < domain.OldestReader())
+//                                       delete old;
+//
+// Entering and leaving are wait-free once a thread has its slot. Each thread
+// owns one slot for as long as it lives, slots are reused by later threads.
+class EpochDomain {
+ public:
+  // The announcement of one reading thread, on a cache line of its own so
+  // readers do not slow each other down.
+  struct alignas(64) Slot {
+    // The epoch the thread entered in, 0 while it is not reading.
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool> in_use{false};
+    // Nested sections only announce once, touched by the owner only.
+    unsigned nesting = 0;
+    Slot* next = nullptr;
+  };
+
+  // A read-side section for the lifetime of the object, left also when the
+  // reader throws.
+  //
+  //   EpochDomain::Section section(domain);
+  //   Read(head.load());
+  class Section {
+   public:
+    explicit Section(EpochDomain& domain)
+        : domain_(domain), slot_(domain.Enter()) {}
+    ~Section() { domain_.Exit(slot_); }
+
+    Section(const Section&) = delete;
+    Section& operator=(const Section&) = delete;
+
+   private:
+    EpochDomain& domain_;
+    Slot* slot_;
+  };
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  // The domain shared by all lock-free structures of the process.
+  static EpochDomain& Default() {
+    // never destroyed, threads may still leave it during static destruction
+    static EpochDomain* domain = new EpochDomain;
+    return *domain;
+  }
+
+  // Enter a read-side section on the calling thread. Objects reachable from
+  // now on are not reclaimed before the matching Exit(). Throws
+  // std::bad_alloc if the first section of a thread cannot allocate its slot.
+  Slot* Enter() {
+    Slot* slot = ThreadSlot();
+    if (slot->nesting++ == 0) {
+      // acquire, so that a reader that sees a new epoch also sees what was
+      // unlinked before it started
+      slot->epoch.store(epoch_.load(std::memory_order_acquire),
+                        std::memory_order_relaxed);
+      // the announcement is visible before anything is read
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    return slot;
+  }
+
+  void Exit(Slot* slot) noexcept {
+    if (--slot->nesting == 0) {
+      slot->epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  // Start a new epoch after unlinking objects, and return the epoch they are
+  // retired in.
+  std::uint64_t Advance() noexcept {
+    return epoch_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  // The oldest epoch a reader is still in, or the maximum if none is reading.
+  // Objects retired in an earlier epoch can be reclaimed.
+  std::uint64_t OldestReader() const noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    for (Slot* slot = head_.load(std::memory_order_acquire); slot;
+         slot = slot->next) {
+      std::uint64_t epoch = slot->epoch.load(std::memory_order_acquire);
+      if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+    return oldest;
+  }
+
+ private:
+  EpochDomain() = default;
+
+  // Takes a free slot for the calling thread and gives it back at exit.
+  class SlotOwner {
+   public:
+    explicit SlotOwner(EpochDomain* domain) : slot_(domain->Acquire()) {}
+    ~SlotOwner() { slot_->in_use.store(false, std::memory_order_release); }
+
+    Slot* Get() const noexcept { return slot_; }
+
+   private:
+    Slot* slot_;
+  };
+
+  Slot* ThreadSlot() {
+    thread_local SlotOwner owner(this);
+    return owner.Get();
+  }
+
+  Slot* Acquire() {
+    for (Slot* slot = head_.load(std::memory_order_acquire); slot;
+         slot = slot->next) {
+      bool expected = false;
+      if (!slot->in_use.load(std::memory_order_relaxed) &&
+          slot->in_use.compare_exchange_strong(expected, true,
+                                               std::memory_order_acquire)) {
+        return slot;
+      }
+    }
+    // slots are never freed, writers may be scanning them
+    Slot* slot = new Slot;
+    slot->in_use.store(true, std::memory_order_relaxed);
+    slot->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(slot->next, slot,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    return slot;
+  }
+
+  // Starts at 1, a slot announcing 0 is not reading.
+  std::atomic<std::uint64_t> epoch_{1};
+  std::atomic<Slot*> head_{nullptr};
+};
+
+}  // namespace cpp_idioms